@@ -0,0 +1,262 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QFocusEvent>
+
+#include "codeparser.h"
+#include "completer.h"
+#include "editor.h"
+#include "highlighter.h"
+#include "page.h"
+#include "syntaxdefinition.h"
+#include "qkide_global.h"
+
+class EditorBench : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void codeParserLoadTags_data();
+    void codeParserLoadTags();
+    void highlighterHighlightBlock_data();
+    void highlighterHighlightBlock();
+    void completerUpdateModel_data();
+    void completerUpdateModel();
+    void pageBraceMatch_data();
+    void pageBraceMatch();
+    void pageFunctionTooltip();
+    void editorUpdatePageText_data();
+    void editorUpdatePageText();
+
+private:
+    QTemporaryDir m_dir;
+
+    static QString source(int lines);
+    QString tagsFile(int count);
+    static QList<CodeParser::Element> elements(int count);
+    static void addSizes(const QString &name, const QList<int> &sizes);
+};
+
+// synthetic C close to what the SDK headers and user projects look like:
+// comments, preprocessor lines, literals and nested blocks
+QString EditorBench::source(int lines)
+{
+    QString text;
+    text.reserve(lines * 40);
+    int n = 0;
+    while(n < lines)
+    {
+        int i = n;
+        text += QString("/* function %1 handles the board event */\n").arg(i);
+        text += QString("#define FUNC_%1_MASK 0x%2\n").arg(i).arg(i & 0xFF, 2, 16, QChar('0'));
+        text += QString("int func_%1(int value, const char *name)\n").arg(i);
+        text += "{\n";
+        text += "    int i, sum = 0;\n";
+        text += QString("    for(i = 0; i < %1; i++)\n").arg(i % 32 + 1);
+        text += "    {\n";
+        text += QString("        if((value & FUNC_%1_MASK) != 0) // check the mask\n").arg(i);
+        text += "            sum += qk_board_read(i, \"sample\");\n";
+        text += "    }\n";
+        text += "    return sum;\n";
+        text += "}\n";
+        n += 12;
+    }
+    return text;
+}
+
+QString EditorBench::tagsFile(int count)
+{
+    QString filePath = m_dir.path() + QString("/tags_%1").arg(count);
+    if(QFile::exists(filePath))
+        return filePath;
+
+    static const char *kinds[] = { "f", "p", "d", "v", "t", "e" };
+
+    QFile file(filePath);
+    file.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream out(&file);
+    out << "!_TAG_FILE_FORMAT\t2\t/extended format/\n";
+    for(int i = 0; i < count; i++)
+    {
+        QString kind = kinds[i % 6];
+        out << "symbol_" << i << "\t"
+            << "src/module_" << (i / 100) << ".c\t"
+            << "/^int symbol_" << i << "(int value, const char *name)$/;\"\t"
+            << kind << "\tline:" << (i % 1000 + 1) << "\n";
+    }
+    return filePath;
+}
+
+QList<CodeParser::Element> EditorBench::elements(int count)
+{
+    QList<CodeParser::Element> list;
+    for(int i = 0; i < count; i++)
+    {
+        CodeParser::Element el;
+        el.text = QString("symbol_%1").arg(i);
+        el.fileName = QString("src/module_%1.c").arg(i / 100);
+        el.expression = QString("/^int symbol_%1(int value, const char *name)$/;").arg(i);
+        el.prototype = QString("int symbol_%1(int value, const char *name)").arg(i);
+        el.type = (CodeParser::Element::Type)(i % 5 + 1);
+        el.local = false;
+        el.declaration = false;
+        el.line = i % 1000 + 1;
+        list.append(el);
+    }
+    return list;
+}
+
+void EditorBench::addSizes(const QString &name, const QList<int> &sizes)
+{
+    QTest::addColumn<int>("size");
+    foreach(int size, sizes)
+        QTest::newRow(QString("%1 %2").arg(size).arg(name).toLatin1()) << size;
+}
+
+void EditorBench::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QVERIFY(SyntaxDefinition::instance()->load(QString(QKIDE_SOURCE_DIR) + THEME_DIR +
+                                               "/syntax/white.syntax"));
+}
+
+void EditorBench::codeParserLoadTags_data()
+{
+    addSizes("tags", QList<int>() << 1000 << 10000);
+}
+
+void EditorBench::codeParserLoadTags()
+{
+    QFETCH(int, size);
+    QString filePath = tagsFile(size);
+
+    CodeParser parser;
+    QBENCHMARK {
+        parser.loadTags(filePath);
+    }
+    QVERIFY(!parser.tags().isEmpty());
+}
+
+void EditorBench::highlighterHighlightBlock_data()
+{
+    addSizes("lines", QList<int>() << 1000 << 10000);
+}
+
+void EditorBench::highlighterHighlightBlock()
+{
+    QFETCH(int, size);
+
+    QTextDocument document(source(size));
+    Highlighter highlighter(&document);
+    highlighter.addElements(elements(500), true);
+
+    // rehighlight() runs highlightBlock() once per block
+    QBENCHMARK {
+        highlighter.rehighlight();
+    }
+}
+
+void EditorBench::completerUpdateModel_data()
+{
+    addSizes("elements", QList<int>() << 1000 << 10000);
+}
+
+void EditorBench::completerUpdateModel()
+{
+    QFETCH(int, size);
+    QList<CodeParser::Element> list = elements(size);
+
+    Completer completer;
+    QBENCHMARK {
+        completer.clearElements(true);
+        completer.addElements(list, true);
+    }
+    QVERIFY(completer.signature("symbol_2") != 0);
+}
+
+void EditorBench::pageBraceMatch_data()
+{
+    addSizes("lines", QList<int>() << 1000 << 10000);
+}
+
+void EditorBench::pageBraceMatch()
+{
+    QFETCH(int, size);
+
+    // a brace that closes at the very end of the text is the worst case
+    Page page("bench.c");
+    page.setPlainText("{\n" + source(size) + "}\n");
+    QTextCursor cursor = page.textCursor();
+    cursor.setPosition(1);
+    page.setTextCursor(cursor);
+
+    QBENCHMARK {
+        QMetaObject::invokeMethod(&page, "braceMatch");
+    }
+}
+
+void EditorBench::pageFunctionTooltip()
+{
+    Page page("bench.c");
+    page.completer()->addElements(elements(1000), true);
+    page.setPlainText(source(200) + "void test(void)\n{\n    symbol_2(1, \n}\n");
+    page.show();
+
+    QTextCursor cursor = page.textCursor();
+    cursor.movePosition(QTextCursor::End);
+    cursor.movePosition(QTextCursor::Up);
+    cursor.movePosition(QTextCursor::EndOfLine);
+    page.setTextCursor(cursor);
+
+    QBENCHMARK {
+        QTest::keyClick(&page, Qt::Key_Space, Qt::ControlModifier | Qt::ShiftModifier);
+    }
+}
+
+void EditorBench::editorUpdatePageText_data()
+{
+    addSizes("lines", QList<int>() << 1000 << 10000);
+}
+
+void EditorBench::editorUpdatePageText()
+{
+    QFETCH(int, size);
+
+    Editor editor;
+    Page *page = editor.addPage("bench.c");
+    page->setPlainText(source(size));
+    editor.splitHorizontal();
+
+    // the split copy is only kept in sync for the focused page
+    QFocusEvent focusIn(QEvent::FocusIn);
+    QApplication::sendEvent(page, &focusIn);
+
+    QBENCHMARK {
+        page->insertPlainText("x");
+    }
+}
+
+QTEST_MAIN(EditorBench)
+
+#include "editorbench.moc"
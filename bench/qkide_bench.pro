@@ -0,0 +1,65 @@
+#-------------------------------------------------
+#
+# Editor micro-benchmarks
+#
+# ./qkide_bench -platform offscreen -o bench.xml,xml
+#
+#-------------------------------------------------
+
+QT       += core gui testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = qkide_bench
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+DEFINES += QKIDE_SOURCE_DIR=\\\"$$PWD/..\\\"
+
+INCLUDEPATH += ..
+INCLUDEPATH += ../core
+INCLUDEPATH += ../gui
+INCLUDEPATH += ../gui/editor
+
+SOURCES += editorbench.cpp \
+    ../gui/editor/codeparser.cpp \
+    ../gui/editor/codetip.cpp \
+    ../gui/editor/completer.cpp \
+    ../gui/editor/editor.cpp \
+    ../gui/editor/findreplacedialog.cpp \
+    ../gui/editor/highlighter.cpp \
+    ../gui/editor/matchcounter.cpp \
+    ../gui/editor/page.cpp \
+    ../gui/editor/pagetab.cpp \
+    ../gui/editor/preprocessor.cpp \
+    ../gui/editor/semanticindexer.cpp \
+    ../gui/editor/syntaxdefinition.cpp \
+    ../core/filesaver.cpp \
+    ../core/occurrenceindex.cpp \
+    ../core/applog.cpp \
+    ../core/perfcounters.cpp \
+    ../core/stallwatchdog.cpp \
+    ../core/textfile.cpp
+
+HEADERS += ../gui/editor/codeparser.h \
+    ../gui/editor/codetip.h \
+    ../gui/editor/completer.h \
+    ../gui/editor/editor.h \
+    ../gui/editor/findreplacedialog.h \
+    ../gui/editor/highlighter.h \
+    ../gui/editor/matchcounter.h \
+    ../gui/editor/page.h \
+    ../gui/editor/pagetab.h \
+    ../gui/editor/preprocessor.h \
+    ../gui/editor/semanticindexer.h \
+    ../gui/editor/syntaxdefinition.h \
+    ../core/filesaver.h \
+    ../core/occurrenceindex.h \
+    ../core/applog.h \
+    ../core/perfcounters.h \
+    ../core/stallwatchdog.h \
+    ../core/textfile.h
+
+FORMS += ../gui/editor/codetip.ui \
+    ../gui/editor/findreplacedialog.ui
@@ -0,0 +1,115 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "applog.h"
+
+#include <QMutex>
+#include <QVector>
+#include <QStringList>
+
+QAtomicInt AppLog::m_enabled;
+
+static const char *categoryNames[AppLog::CategoryCount] = {
+    "editor",
+    "parser",
+    "project",
+    "build",
+    "serial"
+};
+
+// written from any thread, so a mutex rather than the SPSC RingBuffer
+static QMutex entriesMutex;
+static QVector<AppLog::Entry> entriesRing;
+static int entriesSerial = 0;
+
+void AppLog::setEnabled(Category category, bool enabled)
+{
+    int mask = m_enabled.load();
+    if(enabled)
+        mask |= (1 << category);
+    else
+        mask &= ~(1 << category);
+    m_enabled.store(mask);
+}
+
+void AppLog::setRules(const QString &rules)
+{
+    QStringList names = rules.split(',', QString::SkipEmptyParts);
+    for(int i = 0; i < names.count(); i++)
+        names[i] = names[i].trimmed().toLower();
+
+    int mask = 0;
+    for(int c = 0; c < CategoryCount; c++)
+    {
+        if(names.contains("*") || names.contains(categoryNames[c]))
+            mask |= (1 << c);
+    }
+    m_enabled.store(mask);
+}
+
+QString AppLog::rules()
+{
+    QStringList names;
+    for(int c = 0; c < CategoryCount; c++)
+    {
+        if(isEnabled((Category)c))
+            names.append(categoryNames[c]);
+    }
+    if(names.count() == CategoryCount)
+        return "*";
+    return names.join(",");
+}
+
+const char* AppLog::name(Category category)
+{
+    return categoryNames[category];
+}
+
+void AppLog::write(Category category, const QString &text)
+{
+    Entry entry;
+    entry.time = QTime::currentTime();
+    entry.category = category;
+    entry.text = text;
+
+    entriesMutex.lock();
+    if(entriesRing.isEmpty())
+        entriesRing.resize(MaxEntries);
+    entriesRing[entriesSerial % MaxEntries] = entry;
+    entriesSerial++;
+    entriesMutex.unlock();
+
+#ifndef QT_NO_DEBUG
+    qDebug("%s: %s", categoryNames[category], qPrintable(text));
+#endif
+}
+
+QList<AppLog::Entry> AppLog::entries(int *serial)
+{
+    QList<Entry> list;
+
+    entriesMutex.lock();
+    int first = qMax(*serial, entriesSerial - MaxEntries);
+    for(int i = first; i < entriesSerial; i++)
+        list.append(entriesRing[i % MaxEntries]);
+    *serial = entriesSerial;
+    entriesMutex.unlock();
+
+    return list;
+}
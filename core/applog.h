@@ -0,0 +1,96 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef APPLOG_H
+#define APPLOG_H
+
+#include <QString>
+#include <QList>
+#include <QTime>
+#include <QDebug>
+#include <QAtomicInt>
+
+/*
+ * Categorized debug log. A disabled category costs one atomic load: the
+ * message operands are not even evaluated. Enabled messages go to an
+ * in-memory ring shown by the log dock, and to stderr in debug builds.
+ *
+ *     qkLog(Editor) << "completion type:" << type;
+ */
+#define qkLog(category) \
+    for(bool qk_log_enabled = AppLog::isEnabled(AppLog::category); \
+        qk_log_enabled; qk_log_enabled = false) \
+        AppLog::Message(AppLog::category).stream()
+
+class AppLog
+{
+public:
+    enum Category
+    {
+        Editor = 0,
+        Parser,
+        Project,
+        Build,
+        Serial,
+        CategoryCount
+    };
+
+    class Entry
+    {
+    public:
+        QTime time;
+        Category category;
+        QString text;
+    };
+
+    class Message
+    {
+    public:
+        explicit Message(Category category) : m_category(category) {}
+        ~Message() { AppLog::write(m_category, m_text); }
+        QDebug stream() { return QDebug(&m_text); }
+    private:
+        Category m_category;
+        QString m_text;
+    };
+
+    static bool isEnabled(Category category)
+    {
+        return (m_enabled.load() & (1 << category)) != 0;
+    }
+    static void setEnabled(Category category, bool enabled);
+
+    // comma separated category names, "*" for all of them
+    static void setRules(const QString &rules);
+    static QString rules();
+
+    static const char* name(Category category);
+    static void write(Category category, const QString &text);
+    static QList<Entry> entries(int *serial);
+
+private:
+    enum
+    {
+        MaxEntries = 2000
+    };
+
+    static QAtomicInt m_enabled;
+};
+
+#endif // APPLOG_H
@@ -0,0 +1,213 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batchuploaddialog.h"
+#include "batchuploader.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+
+BatchUploadDialog::BatchUploadDialog(BatchUploader *uploader, QWidget *parent) :
+    QDialog(parent),
+    m_uploader(uploader)
+{
+    setWindowFlags(Qt::Tool);
+    setWindowTitle(tr("Batch Upload"));
+
+    m_table = new QTableWidget(0, 3, this);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("Port")
+                                                     << tr("Progress")
+                                                     << tr("Status"));
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->verticalHeader()->hide();
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setWordWrap(true);
+
+    m_uploadButton = new QPushButton(tr("Upload"), this);
+    m_abortButton = new QPushButton(tr("Abort"), this);
+    m_closeButton = new QPushButton(tr("Close"), this);
+
+    QHBoxLayout *buttonsLayout = new QHBoxLayout;
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(m_uploadButton);
+    buttonsLayout->addWidget(m_abortButton);
+    buttonsLayout->addWidget(m_closeButton);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(m_table);
+    mainLayout->addWidget(m_summaryLabel);
+    mainLayout->addLayout(buttonsLayout);
+    setLayout(mainLayout);
+
+    connect(m_uploadButton, SIGNAL(clicked()), this, SLOT(slotUpload()));
+    connect(m_abortButton, SIGNAL(clicked()), m_uploader, SLOT(abort()));
+    connect(m_closeButton, SIGNAL(clicked()), this, SLOT(hide()));
+    connect(m_table, SIGNAL(cellDoubleClicked(int,int)), this, SLOT(slotShowOutput(int,int)));
+
+    connect(m_uploader, SIGNAL(stateChanged(QString,int)), this, SLOT(slotStateChanged(QString,int)));
+    connect(m_uploader, SIGNAL(progress(QString,int)), this, SLOT(slotProgress(QString,int)));
+    connect(m_uploader, SIGNAL(finished()), this, SLOT(slotFinished()));
+
+    resize(420, 300);
+    updateInterface();
+}
+
+void BatchUploadDialog::setPorts(const QStringList &portNames)
+{
+    if(m_uploader->isRunning())
+        return;
+
+    QStringList checked = selectedPorts();
+
+    m_table->setRowCount(0);
+    foreach(QString portName, portNames)
+    {
+        int r = m_table->rowCount();
+        m_table->insertRow(r);
+
+        QTableWidgetItem *item = new QTableWidgetItem(portName);
+        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable | Qt::ItemIsSelectable);
+        bool check = checked.isEmpty() || checked.contains(portName);
+        item->setCheckState(check ? Qt::Checked : Qt::Unchecked);
+        m_table->setItem(r, ColumnPort, item);
+
+        QProgressBar *progressBar = new QProgressBar(m_table);
+        progressBar->setRange(0, 100);
+        progressBar->setValue(0);
+        m_table->setCellWidget(r, ColumnProgress, progressBar);
+
+        m_table->setItem(r, ColumnStatus, new QTableWidgetItem());
+    }
+
+    m_summaryLabel->clear();
+    updateInterface();
+}
+
+QStringList BatchUploadDialog::selectedPorts()
+{
+    QStringList list;
+    for(int r = 0; r < m_table->rowCount(); r++)
+    {
+        QTableWidgetItem *item = m_table->item(r, ColumnPort);
+        if(item->checkState() == Qt::Checked)
+            list.append(item->text());
+    }
+    return list;
+}
+
+void BatchUploadDialog::slotUpload()
+{
+    QStringList ports = selectedPorts();
+    if(ports.isEmpty())
+        return;
+
+    for(int r = 0; r < m_table->rowCount(); r++)
+    {
+        QProgressBar *progressBar = qobject_cast<QProgressBar*>(m_table->cellWidget(r, ColumnProgress));
+        progressBar->setValue(0);
+        m_table->item(r, ColumnStatus)->setText("");
+    }
+    m_summaryLabel->clear();
+
+    emit uploadRequested(ports);
+    updateInterface();
+}
+
+void BatchUploadDialog::slotStateChanged(const QString &portName, int state)
+{
+    int r = row(portName);
+    if(r == -1)
+        return;
+
+    QString text;
+    switch(state)
+    {
+    case BatchUploader::Waiting:   text = tr("Waiting"); break;
+    case BatchUploader::Uploading: text = tr("Uploading..."); break;
+    case BatchUploader::Succeeded: text = tr("Done"); break;
+    case BatchUploader::Failed:    text = tr("Failed"); break;
+    default: ;
+    }
+
+    QTableWidgetItem *item = m_table->item(r, ColumnStatus);
+    item->setText(text);
+    if(state == BatchUploader::Failed)
+        item->setForeground(QColor("#D8412E"));
+    else
+        item->setForeground(palette().color(QPalette::Text));
+
+    updateInterface();
+}
+
+void BatchUploadDialog::slotProgress(const QString &portName, int percent)
+{
+    int r = row(portName);
+    if(r == -1)
+        return;
+
+    QProgressBar *progressBar = qobject_cast<QProgressBar*>(m_table->cellWidget(r, ColumnProgress));
+    progressBar->setValue(percent);
+}
+
+void BatchUploadDialog::slotFinished()
+{
+    m_summaryLabel->setText(m_uploader->summary());
+    updateInterface();
+}
+
+void BatchUploadDialog::slotShowOutput(int row, int column)
+{
+    Q_UNUSED(column);
+    QString portName = m_table->item(row, ColumnPort)->text();
+    QString output = m_uploader->output(portName);
+    if(output.isEmpty())
+        return;
+
+    QMessageBox box(this);
+    box.setWindowTitle(portName);
+    box.setText(tr("Upload output for %1").arg(portName));
+    box.setDetailedText(output);
+    box.exec();
+}
+
+int BatchUploadDialog::row(const QString &portName)
+{
+    for(int r = 0; r < m_table->rowCount(); r++)
+    {
+        if(m_table->item(r, ColumnPort)->text() == portName)
+            return r;
+    }
+    return -1;
+}
+
+void BatchUploadDialog::updateInterface()
+{
+    bool running = m_uploader->isRunning();
+    m_uploadButton->setEnabled(!running && m_table->rowCount() > 0);
+    m_abortButton->setEnabled(running);
+}
@@ -0,0 +1,69 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCHUPLOADDIALOG_H
+#define BATCHUPLOADDIALOG_H
+
+#include <QDialog>
+
+class BatchUploader;
+class QTableWidget;
+class QPushButton;
+class QLabel;
+
+class BatchUploadDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit BatchUploadDialog(BatchUploader *uploader, QWidget *parent = 0);
+
+    void setPorts(const QStringList &portNames);
+    QStringList selectedPorts();
+
+signals:
+    void uploadRequested(QStringList portNames);
+
+private slots:
+    void slotUpload();
+    void slotStateChanged(const QString &portName, int state);
+    void slotProgress(const QString &portName, int percent);
+    void slotFinished();
+    void slotShowOutput(int row, int column);
+
+private:
+    enum Column
+    {
+        ColumnPort = 0,
+        ColumnProgress,
+        ColumnStatus
+    };
+
+    BatchUploader *m_uploader;
+
+    QTableWidget *m_table;
+    QLabel *m_summaryLabel;
+    QPushButton *m_uploadButton;
+    QPushButton *m_abortButton;
+    QPushButton *m_closeButton;
+
+    int row(const QString &portName);
+    void updateInterface();
+};
+
+#endif // BATCHUPLOADDIALOG_H
@@ -0,0 +1,236 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batchuploader.h"
+#include "applog.h"
+
+#include <QDebug>
+#include <QRegularExpression>
+
+BatchUploader::BatchUploader(QObject *parent) :
+    QObject(parent),
+    m_running(0)
+{
+}
+
+BatchUploader::~BatchUploader()
+{
+    abort();
+    qDeleteAll(m_jobs);
+}
+
+void BatchUploader::addJob(const QString &portName,
+                           const QString &program,
+                           const QStringList &arguments,
+                           const QString &workingDir)
+{
+    if(isRunning())
+    {
+        qDebug() << "can't add upload job while uploading";
+        return;
+    }
+
+    Job *job = new Job;
+    job->portName = portName;
+    job->program = program;
+    job->arguments = arguments;
+    job->workingDir = workingDir;
+    job->state = Waiting;
+    job->progress = 0;
+
+    // each board is flashed by its own process so a slow or stuck
+    // bootloader never delays the others
+    job->process = new QProcess(this);
+    job->process->setProcessChannelMode(QProcess::MergedChannels);
+    job->process->setWorkingDirectory(workingDir);
+    connect(job->process, SIGNAL(readyRead()), this, SLOT(slotProcessOutput()));
+    connect(job->process, SIGNAL(finished(int)), this, SLOT(slotProcessFinished(int)));
+    connect(job->process, SIGNAL(error(QProcess::ProcessError)),
+            this, SLOT(slotProcessError(QProcess::ProcessError)));
+
+    m_jobs.append(job);
+}
+
+void BatchUploader::clear()
+{
+    if(isRunning())
+        return;
+
+    foreach(Job *job, m_jobs)
+        job->process->deleteLater();
+    qDeleteAll(m_jobs);
+    m_jobs.clear();
+}
+
+bool BatchUploader::isRunning()
+{
+    return m_running > 0;
+}
+
+QStringList BatchUploader::ports()
+{
+    QStringList list;
+    foreach(Job *job, m_jobs)
+        list.append(job->portName);
+    return list;
+}
+
+QStringList BatchUploader::failedPorts()
+{
+    QStringList list;
+    foreach(Job *job, m_jobs)
+    {
+        if(job->state == Failed)
+            list.append(job->portName);
+    }
+    return list;
+}
+
+QString BatchUploader::output(const QString &portName)
+{
+    Job *j = job(portName);
+    if(j == 0)
+        return QString();
+    return j->output;
+}
+
+QString BatchUploader::summary()
+{
+    QStringList failed = failedPorts();
+    QString text = tr("Uploaded %1 of %2 boards")
+            .arg(m_jobs.count() - failed.count())
+            .arg(m_jobs.count());
+    if(!failed.isEmpty())
+        text.append(tr(", failed: %1").arg(failed.join(", ")));
+    return text;
+}
+
+void BatchUploader::start()
+{
+    if(isRunning())
+        return;
+
+    foreach(Job *job, m_jobs)
+    {
+        job->output.clear();
+        job->progress = 0;
+        setState(job, Uploading);
+        m_running++;
+
+        qkLog(Build) << "batch upload" << job->portName << job->program << job->arguments;
+        job->process->start(job->program, job->arguments);
+    }
+
+    if(m_jobs.isEmpty())
+        emit finished();
+}
+
+void BatchUploader::abort()
+{
+    foreach(Job *job, m_jobs)
+    {
+        if(job->state == Uploading)
+            job->process->kill();
+    }
+}
+
+void BatchUploader::slotProcessOutput()
+{
+    static const QRegularExpression percentRegExp("(\\d{1,3})\\s*%");
+
+    Job *j = job(qobject_cast<QProcess*>(sender()));
+    if(j == 0)
+        return;
+
+    QString text = QString(j->process->readAll());
+    j->output.append(text);
+
+    int percent = -1;
+    QRegularExpressionMatchIterator it = percentRegExp.globalMatch(text);
+    while(it.hasNext())
+        percent = it.next().captured(1).toInt();
+
+    if(percent >= 0 && percent <= 100 && percent != j->progress)
+    {
+        j->progress = percent;
+        emit progress(j->portName, percent);
+    }
+}
+
+void BatchUploader::slotProcessFinished(int exitCode)
+{
+    Job *j = job(qobject_cast<QProcess*>(sender()));
+    if(j == 0 || j->state != Uploading)
+        return;
+
+    bool ok = (exitCode == 0 && j->process->exitStatus() == QProcess::NormalExit);
+    if(ok && j->progress != 100)
+    {
+        j->progress = 100;
+        emit progress(j->portName, 100);
+    }
+
+    setState(j, ok ? Succeeded : Failed);
+
+    if(--m_running == 0)
+        emit finished();
+}
+
+void BatchUploader::slotProcessError(QProcess::ProcessError error)
+{
+    // finished() is not emitted when the process couldn't even start
+    if(error != QProcess::FailedToStart)
+        return;
+
+    Job *j = job(qobject_cast<QProcess*>(sender()));
+    if(j == 0 || j->state != Uploading)
+        return;
+
+    j->output.append(j->process->errorString());
+    setState(j, Failed);
+
+    if(--m_running == 0)
+        emit finished();
+}
+
+BatchUploader::Job* BatchUploader::job(QProcess *process)
+{
+    foreach(Job *job, m_jobs)
+    {
+        if(job->process == process)
+            return job;
+    }
+    return 0;
+}
+
+BatchUploader::Job* BatchUploader::job(const QString &portName)
+{
+    foreach(Job *job, m_jobs)
+    {
+        if(job->portName == portName)
+            return job;
+    }
+    return 0;
+}
+
+void BatchUploader::setState(Job *job, State state)
+{
+    job->state = state;
+    emit stateChanged(job->portName, state);
+}
@@ -0,0 +1,90 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCHUPLOADER_H
+#define BATCHUPLOADER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QProcess>
+
+class BatchUploader : public QObject
+{
+    Q_OBJECT
+public:
+    enum State
+    {
+        Waiting = 0,
+        Uploading,
+        Succeeded,
+        Failed
+    };
+
+    explicit BatchUploader(QObject *parent = 0);
+    ~BatchUploader();
+
+    void addJob(const QString &portName,
+                const QString &program,
+                const QStringList &arguments,
+                const QString &workingDir);
+    void clear();
+    bool isRunning();
+
+    QStringList ports();
+    QStringList failedPorts();
+    QString output(const QString &portName);
+    QString summary();
+
+signals:
+    void stateChanged(QString portName, int state);
+    void progress(QString portName, int percent);
+    void finished();
+
+public slots:
+    void start();
+    void abort();
+
+private slots:
+    void slotProcessOutput();
+    void slotProcessFinished(int exitCode);
+    void slotProcessError(QProcess::ProcessError error);
+
+private:
+    class Job
+    {
+    public:
+        QString portName;
+        QString program;
+        QStringList arguments;
+        QString workingDir;
+        QProcess *process;
+        State state;
+        int progress;
+        QString output;
+    };
+
+    QList<Job*> m_jobs;
+    int m_running;
+
+    Job* job(QProcess *process);
+    Job* job(const QString &portName);
+    void setState(Job *job, State state);
+};
+
+#endif // BATCHUPLOADER_H
@@ -0,0 +1,136 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "binarylog.h"
+
+#include <QDebug>
+#include <cstring>
+
+BinaryLog::BinaryLog() :
+    m_data(0),
+    m_size(0),
+    m_mappedSize(0)
+{
+}
+
+BinaryLog::~BinaryLog()
+{
+    close();
+}
+
+bool BinaryLog::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        qDebug() << "unable to open log:" << path << m_file.errorString();
+        return false;
+    }
+
+    m_size = 0;
+    if(!grow(ChunkSize))
+    {
+        m_file.close();
+        return false;
+    }
+
+    quint32 version = Version;
+    write("QKLG", 4);
+    write(&version, sizeof(version));
+    return true;
+}
+
+void BinaryLog::close()
+{
+    if(m_data != 0)
+    {
+        m_file.unmap(m_data);
+        m_data = 0;
+    }
+    if(m_file.isOpen())
+    {
+        m_file.resize(m_size);
+        m_file.close();
+    }
+    m_mappedSize = 0;
+}
+
+bool BinaryLog::append(qint64 time, const float *values, int count)
+{
+    quint8 n = (quint8)qMin(count, 255);
+    qint64 length = sizeof(time) + sizeof(n) + n*sizeof(float);
+
+    if(m_data == 0)
+        return false;
+    if(m_size + length > m_mappedSize && !grow(m_size + length))
+        return false;
+
+    uchar *p = m_data + m_size;
+    memcpy(p, &time, sizeof(time));
+    p += sizeof(time);
+    *p++ = n;
+    memcpy(p, values, n*sizeof(float));
+    m_size += length;
+    return true;
+}
+
+bool BinaryLog::write(const void *data, qint64 length)
+{
+    if(m_data == 0)
+        return false;
+    if(m_size + length > m_mappedSize && !grow(m_size + length))
+        return false;
+
+    memcpy(m_data + m_size, data, length);
+    m_size += length;
+    return true;
+}
+
+bool BinaryLog::grow(qint64 minSize)
+{
+    qint64 newSize = m_mappedSize;
+    while(newSize < minSize)
+        newSize += ChunkSize;
+
+    if(m_data != 0)
+    {
+        m_file.unmap(m_data);
+        m_data = 0;
+    }
+
+    if(!m_file.resize(newSize))
+    {
+        qDebug() << "unable to grow log:" << m_file.errorString();
+        m_mappedSize = 0;
+        return false;
+    }
+
+    m_data = m_file.map(0, newSize);
+    if(m_data == 0)
+    {
+        qDebug() << "unable to map log:" << m_file.errorString();
+        m_mappedSize = 0;
+        return false;
+    }
+
+    m_mappedSize = newSize;
+    return true;
+}
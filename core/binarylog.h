@@ -0,0 +1,65 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BINARYLOG_H
+#define BINARYLOG_H
+
+#include <QFile>
+
+/*
+ * Append-only memory-mapped log file. The file grows in large chunks
+ * and is truncated to the written size when closed.
+ *
+ * Layout: "QKLG" magic, quint32 version, then one record per sample:
+ * qint64 time (us), quint8 value count, float values[count]
+ * (native byte order).
+ */
+class BinaryLog
+{
+public:
+    BinaryLog();
+    ~BinaryLog();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() { return m_data != 0; }
+
+    bool append(qint64 time, const float *values, int count);
+
+    QString fileName() { return m_file.fileName(); }
+    qint64 size() { return m_size; }
+    QString errorString() { return m_file.errorString(); }
+
+private:
+    enum
+    {
+        ChunkSize = 4*1024*1024,
+        Version = 1
+    };
+
+    QFile m_file;
+    uchar *m_data;
+    qint64 m_size;
+    qint64 m_mappedSize;
+
+    bool write(const void *data, qint64 length);
+    bool grow(qint64 minSize);
+};
+
+#endif // BINARYLOG_H
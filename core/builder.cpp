@@ -0,0 +1,233 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "builder.h"
+#include "project.h"
+#include "qkide_global.h"
+
+#include <QDebug>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTextStream>
+
+bool Builder::createMakefile(Project *project, const QString &targetName,
+                             const QString &targetVariant)
+{
+    return writeMakefile(project->path() + "/Makefile", project, targetName, targetVariant);
+}
+
+void Builder::deleteMakefile(Project *project)
+{
+    QFile::remove(project->path() + "/Makefile");
+}
+
+bool Builder::writeMakefile(const QString &filePath, Project *project,
+                            const QString &targetName, const QString &targetVariant)
+{
+    QFile makefileTemplateFile(":/templates/makefile_template");
+    if(!makefileTemplateFile.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "unable to open makefile template";
+        return false;
+    }
+
+    QFile makefileFile(filePath);
+    if(!makefileFile.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "unable to create makefile:" << makefileFile.errorString();
+        return false;
+    }
+
+    QTextStream in(&makefileTemplateFile);
+    QTextStream out(&makefileFile);
+    QString makefileTemplate = in.readAll();
+
+    QString appDir = QCoreApplication::applicationDirPath();
+    QString target = targetName.toLower() + "." + targetVariant.toLower();
+
+    makefileTemplate.replace("{{embDir}}", appDir + EMB_DIR);
+    makefileTemplate.replace("{{toolchainDir}}", appDir + TOOLCHAIN_DIR);
+    makefileTemplate.replace("{{appDir}}", project->path());
+    makefileTemplate.replace("{{target}}", target);
+
+    out << makefileTemplate;
+    return true;
+}
+
+QString Builder::makeProgram()
+{
+#ifdef Q_OS_WIN
+    return QCoreApplication::applicationDirPath() + GNUWIN_DIR + "/bin/make.exe";
+#else
+    return "make";
+#endif
+}
+
+QStringList Builder::cleanArguments(Project *project)
+{
+    QStringList arguments;
+    arguments << "clean";
+    arguments << "APP=" + project->path();
+    return arguments;
+}
+
+QStringList Builder::verifyArguments(Project *project)
+{
+    QStringList arguments;
+    arguments << "app";
+    arguments << "APP=" + project->path();
+    arguments << "PROJECT_NAME=" + project->name();
+    return arguments;
+}
+
+QStringList Builder::uploadArguments(Project *project, const QString &portName)
+{
+    QStringList arguments;
+    arguments << "upload";
+#ifdef Q_OS_WIN
+    arguments << "PORT=" + portName;
+#else
+    if(portName.startsWith("/"))
+        arguments << "PORT=" + portName;
+    else
+        arguments << "PORT=/dev/" + portName;
+#endif
+    arguments << "FILE=" + project->path() + "bin/" + project->name() + ".bin";
+    return arguments;
+}
+
+QStringList Builder::matrixArguments(Project *project, const QString &makefilePath,
+                                     const QString &target, const QString &buildDir)
+{
+    // variables given on the command line override the makefile ones, so
+    // one makefile serves every target and objects never collide
+    QStringList arguments;
+    arguments << "-f" << makefilePath;
+    arguments << verifyArguments(project);
+    arguments << "TARGET=" + target;
+    arguments << "BUILD_DIR=" + buildDir;
+    return arguments;
+}
+
+bool Builder::isHeadless(int argc, char *argv[])
+{
+    for(int i = 1; i < argc; i++)
+        if(qstrcmp(argv[i], "--build") == 0 || qstrcmp(argv[i], "--upload") == 0)
+            return true;
+    return false;
+}
+
+int Builder::run(const QStringList &arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QString mode, projectPath, target, portName;
+    for(int i = 1; i < arguments.count(); i++)
+    {
+        QString arg = arguments[i];
+        QString value = i + 1 < arguments.count() ? arguments[i + 1] : QString();
+        if(arg == "--build" || arg == "--upload")
+        {
+            mode = arg.mid(2);
+            projectPath = value;
+            i++;
+        }
+        else if(arg == "--target")
+        {
+            target = value;
+            i++;
+        }
+        else if(arg == "--port")
+        {
+            portName = value;
+            i++;
+        }
+        else
+        {
+            err << "unknown argument: " << arg << endl;
+            printUsage();
+            return 2;
+        }
+    }
+
+    int dot = target.indexOf('.');
+    if(projectPath.isEmpty() || dot <= 0 || dot == target.count() - 1 ||
+       (mode == "upload" && portName.isEmpty()))
+    {
+        printUsage();
+        return 2;
+    }
+
+    Project project;
+    if(!QFileInfo(projectPath).isFile() ||
+       !project.loadFromFile(QFileInfo(projectPath).absoluteFilePath()))
+    {
+        err << "unable to open project: " << projectPath << endl;
+        return 1;
+    }
+
+    if(!createMakefile(&project, target.left(dot), target.mid(dot + 1)))
+    {
+        err << "unable to create makefile in: " << project.path() << endl;
+        return 1;
+    }
+
+    QStringList makeArguments;
+    if(mode == "build")
+        makeArguments = verifyArguments(&project);
+    else
+        makeArguments = uploadArguments(&project, portName);
+
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.setWorkingDirectory(project.path());
+    process.start(makeProgram(), makeArguments);
+
+    if(!process.waitForStarted())
+    {
+        err << "unable to start " << makeProgram() << ": " << process.errorString() << endl;
+        deleteMakefile(&project);
+        return 1;
+    }
+
+    while(process.state() != QProcess::NotRunning)
+    {
+        process.waitForReadyRead(-1);
+        out << process.readAll();
+        out.flush();
+    }
+    out << process.readAll();
+    out.flush();
+
+    deleteMakefile(&project);
+
+    if(process.exitStatus() != QProcess::NormalExit)
+        return 1;
+    return process.exitCode();
+}
+
+void Builder::printUsage()
+{
+    QTextStream(stderr) << "usage:" << endl
+                        << "  qkide --build <project.qkpro> --target <name.variant>" << endl
+                        << "  qkide --upload <project.qkpro> --target <name.variant> --port <port>" << endl;
+}
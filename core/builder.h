@@ -0,0 +1,58 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUILDER_H
+#define BUILDER_H
+
+#include <QString>
+#include <QStringList>
+
+class Project;
+
+/*
+ * Makefile generation and make invocation shared by the IDE and the
+ * headless command line mode:
+ *
+ *   qkide --build <project.qkpro> --target <name.variant>
+ *   qkide --upload <project.qkpro> --target <name.variant> --port <port>
+ */
+class Builder
+{
+public:
+    static bool createMakefile(Project *project, const QString &targetName,
+                               const QString &targetVariant);
+    static void deleteMakefile(Project *project);
+    static bool writeMakefile(const QString &filePath, Project *project,
+                              const QString &targetName, const QString &targetVariant);
+
+    static QString makeProgram();
+    static QStringList cleanArguments(Project *project);
+    static QStringList verifyArguments(Project *project);
+    static QStringList uploadArguments(Project *project, const QString &portName);
+    static QStringList matrixArguments(Project *project, const QString &makefilePath,
+                                       const QString &target, const QString &buildDir);
+
+    static bool isHeadless(int argc, char *argv[]);
+    static int run(const QStringList &arguments);
+
+private:
+    static void printUsage();
+};
+
+#endif // BUILDER_H
@@ -0,0 +1,288 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buildmatrix.h"
+#include "applog.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QThread>
+
+BuildMatrix::BuildMatrix(QObject *parent) :
+    QObject(parent),
+    m_running(0),
+    m_aborted(false)
+{
+    m_maxRunning = qMax(1, QThread::idealThreadCount());
+}
+
+BuildMatrix::~BuildMatrix()
+{
+    abort();
+    qDeleteAll(m_jobs);
+}
+
+void BuildMatrix::addJob(const QString &target,
+                         const QString &program,
+                         const QStringList &arguments,
+                         const QString &workingDir,
+                         const QString &binaryPath)
+{
+    if(isRunning())
+    {
+        qDebug() << "can't add build job while building";
+        return;
+    }
+
+    Job *job = new Job;
+    job->target = target;
+    job->program = program;
+    job->arguments = arguments;
+    job->binaryPath = binaryPath;
+    job->state = Waiting;
+    job->flashSize = -1;
+    job->ramSize = -1;
+
+    job->process = new QProcess(this);
+    job->process->setProcessChannelMode(QProcess::MergedChannels);
+    job->process->setWorkingDirectory(workingDir);
+    connect(job->process, SIGNAL(readyRead()), this, SLOT(slotProcessOutput()));
+    connect(job->process, SIGNAL(finished(int)), this, SLOT(slotProcessFinished(int)));
+    connect(job->process, SIGNAL(error(QProcess::ProcessError)),
+            this, SLOT(slotProcessError(QProcess::ProcessError)));
+
+    m_jobs.append(job);
+}
+
+void BuildMatrix::clear()
+{
+    if(isRunning())
+        return;
+
+    foreach(Job *job, m_jobs)
+        job->process->deleteLater();
+    qDeleteAll(m_jobs);
+    m_jobs.clear();
+}
+
+bool BuildMatrix::isRunning()
+{
+    return m_running > 0;
+}
+
+void BuildMatrix::setMaxRunning(int count)
+{
+    m_maxRunning = qMax(1, count);
+}
+
+QStringList BuildMatrix::targets()
+{
+    QStringList list;
+    foreach(Job *job, m_jobs)
+        list.append(job->target);
+    return list;
+}
+
+QStringList BuildMatrix::failedTargets()
+{
+    QStringList list;
+    foreach(Job *job, m_jobs)
+    {
+        if(job->state == Failed)
+            list.append(job->target);
+    }
+    return list;
+}
+
+QString BuildMatrix::output(const QString &target)
+{
+    Job *j = job(target);
+    if(j == 0)
+        return QString();
+    return j->output;
+}
+
+qint64 BuildMatrix::flashSize(const QString &target)
+{
+    Job *j = job(target);
+    if(j == 0)
+        return -1;
+    return j->flashSize;
+}
+
+qint64 BuildMatrix::ramSize(const QString &target)
+{
+    Job *j = job(target);
+    if(j == 0)
+        return -1;
+    return j->ramSize;
+}
+
+QString BuildMatrix::summary()
+{
+    QStringList failed = failedTargets();
+    QString text = tr("Built %1 of %2 targets")
+            .arg(m_jobs.count() - failed.count())
+            .arg(m_jobs.count());
+    if(!failed.isEmpty())
+        text.append(tr(", failed: %1").arg(failed.join(", ")));
+    return text;
+}
+
+void BuildMatrix::start()
+{
+    if(isRunning())
+        return;
+
+    m_aborted = false;
+    foreach(Job *job, m_jobs)
+    {
+        job->output.clear();
+        job->flashSize = -1;
+        job->ramSize = -1;
+        setState(job, Waiting);
+    }
+
+    // every target builds in its own directory, but no more than one
+    // compiler per core so the editor stays responsive
+    startNext();
+
+    if(m_running == 0)
+        emit finished();
+}
+
+void BuildMatrix::abort()
+{
+    m_aborted = true;
+    foreach(Job *job, m_jobs)
+    {
+        if(job->state == Building)
+            job->process->kill();
+    }
+}
+
+void BuildMatrix::startNext()
+{
+    foreach(Job *job, m_jobs)
+    {
+        if(m_aborted || m_running >= m_maxRunning)
+            break;
+        if(job->state != Waiting)
+            continue;
+
+        setState(job, Building);
+        m_running++;
+
+        qkLog(Build) << "build matrix" << job->target << job->program << job->arguments;
+        job->process->start(job->program, job->arguments);
+    }
+}
+
+void BuildMatrix::slotProcessOutput()
+{
+    Job *j = job(qobject_cast<QProcess*>(sender()));
+    if(j == 0)
+        return;
+
+    j->output.append(QString(j->process->readAll()));
+}
+
+void BuildMatrix::slotProcessFinished(int exitCode)
+{
+    Job *j = job(qobject_cast<QProcess*>(sender()));
+    if(j == 0 || j->state != Building)
+        return;
+
+    bool ok = (exitCode == 0 && j->process->exitStatus() == QProcess::NormalExit);
+    if(ok)
+    {
+        QFileInfo binary(j->binaryPath);
+        if(binary.exists())
+            j->flashSize = binary.size();
+
+        // "text data bss dec hex filename" printed by size after linking
+        static const QRegularExpression sizeRegExp("^\\s*(\\d+)\\s+(\\d+)\\s+(\\d+)\\s+\\d+\\s+[0-9a-fA-F]+\\s",
+                                                   QRegularExpression::MultilineOption);
+        QRegularExpressionMatch match = sizeRegExp.match(j->output);
+        if(match.hasMatch())
+            j->ramSize = match.captured(2).toLongLong() + match.captured(3).toLongLong();
+    }
+
+    jobDone(j, ok);
+}
+
+void BuildMatrix::slotProcessError(QProcess::ProcessError error)
+{
+    // finished() is not emitted when the process couldn't even start
+    if(error != QProcess::FailedToStart)
+        return;
+
+    Job *j = job(qobject_cast<QProcess*>(sender()));
+    if(j == 0 || j->state != Building)
+        return;
+
+    j->output.append(j->process->errorString());
+    jobDone(j, false);
+}
+
+void BuildMatrix::jobDone(Job *j, bool ok)
+{
+    setState(j, ok ? Passed : Failed);
+    m_running--;
+
+    startNext();
+
+    if(m_running == 0)
+    {
+        // jobs that never started after an abort count as failed
+        foreach(Job *job, m_jobs)
+        {
+            if(job->state == Waiting)
+                setState(job, Failed);
+        }
+        emit finished();
+    }
+}
+
+BuildMatrix::Job* BuildMatrix::job(QProcess *process)
+{
+    foreach(Job *job, m_jobs)
+    {
+        if(job->process == process)
+            return job;
+    }
+    return 0;
+}
+
+BuildMatrix::Job* BuildMatrix::job(const QString &target)
+{
+    foreach(Job *job, m_jobs)
+    {
+        if(job->target == target)
+            return job;
+    }
+    return 0;
+}
+
+void BuildMatrix::setState(Job *job, State state)
+{
+    job->state = state;
+    emit stateChanged(job->target, state);
+}
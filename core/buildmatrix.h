@@ -0,0 +1,98 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUILDMATRIX_H
+#define BUILDMATRIX_H
+
+#include <QObject>
+#include <QStringList>
+#include <QProcess>
+
+class BuildMatrix : public QObject
+{
+    Q_OBJECT
+public:
+    enum State
+    {
+        Waiting = 0,
+        Building,
+        Passed,
+        Failed
+    };
+
+    explicit BuildMatrix(QObject *parent = 0);
+    ~BuildMatrix();
+
+    void addJob(const QString &target,
+                const QString &program,
+                const QStringList &arguments,
+                const QString &workingDir,
+                const QString &binaryPath);
+    void clear();
+    bool isRunning();
+    void setMaxRunning(int count);
+
+    QStringList targets();
+    QStringList failedTargets();
+    QString output(const QString &target);
+    qint64 flashSize(const QString &target);
+    qint64 ramSize(const QString &target);
+    QString summary();
+
+signals:
+    void stateChanged(QString target, int state);
+    void finished();
+
+public slots:
+    void start();
+    void abort();
+
+private slots:
+    void slotProcessOutput();
+    void slotProcessFinished(int exitCode);
+    void slotProcessError(QProcess::ProcessError error);
+
+private:
+    class Job
+    {
+    public:
+        QString target;
+        QString program;
+        QStringList arguments;
+        QString binaryPath;
+        QProcess *process;
+        State state;
+        QString output;
+        qint64 flashSize;
+        qint64 ramSize;
+    };
+
+    QList<Job*> m_jobs;
+    int m_running;
+    int m_maxRunning;
+    bool m_aborted;
+
+    Job* job(QProcess *process);
+    Job* job(const QString &target);
+    void setState(Job *job, State state);
+    void startNext();
+    void jobDone(Job *j, bool ok);
+};
+
+#endif // BUILDMATRIX_H
@@ -0,0 +1,204 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buildmatrixdialog.h"
+#include "buildmatrix.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+
+BuildMatrixDialog::BuildMatrixDialog(BuildMatrix *matrix, QWidget *parent) :
+    QDialog(parent),
+    m_matrix(matrix)
+{
+    setWindowFlags(Qt::Tool);
+    setWindowTitle(tr("Verify All Targets"));
+
+    m_table = new QTableWidget(0, 4, this);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("Target")
+                                                     << tr("Status")
+                                                     << tr("Flash")
+                                                     << tr("RAM"));
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->verticalHeader()->hide();
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setWordWrap(true);
+
+    m_buildButton = new QPushButton(tr("Build"), this);
+    m_abortButton = new QPushButton(tr("Abort"), this);
+    m_closeButton = new QPushButton(tr("Close"), this);
+
+    QHBoxLayout *buttonsLayout = new QHBoxLayout;
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(m_buildButton);
+    buttonsLayout->addWidget(m_abortButton);
+    buttonsLayout->addWidget(m_closeButton);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(m_table);
+    mainLayout->addWidget(m_summaryLabel);
+    mainLayout->addLayout(buttonsLayout);
+    setLayout(mainLayout);
+
+    connect(m_buildButton, SIGNAL(clicked()), this, SLOT(slotBuild()));
+    connect(m_abortButton, SIGNAL(clicked()), m_matrix, SLOT(abort()));
+    connect(m_closeButton, SIGNAL(clicked()), this, SLOT(hide()));
+    connect(m_table, SIGNAL(cellDoubleClicked(int,int)), this, SLOT(slotShowOutput(int,int)));
+
+    connect(m_matrix, SIGNAL(stateChanged(QString,int)), this, SLOT(slotStateChanged(QString,int)));
+    connect(m_matrix, SIGNAL(finished()), this, SLOT(slotFinished()));
+
+    resize(480, 360);
+    updateInterface();
+}
+
+void BuildMatrixDialog::setTargets(const QStringList &targets)
+{
+    if(m_matrix->isRunning())
+        return;
+
+    QStringList checked = selectedTargets();
+
+    m_table->setRowCount(0);
+    foreach(QString target, targets)
+    {
+        int r = m_table->rowCount();
+        m_table->insertRow(r);
+
+        QTableWidgetItem *item = new QTableWidgetItem(target);
+        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable | Qt::ItemIsSelectable);
+        bool check = checked.isEmpty() || checked.contains(target);
+        item->setCheckState(check ? Qt::Checked : Qt::Unchecked);
+        m_table->setItem(r, ColumnTarget, item);
+
+        m_table->setItem(r, ColumnStatus, new QTableWidgetItem());
+        m_table->setItem(r, ColumnFlash, new QTableWidgetItem());
+        m_table->setItem(r, ColumnRam, new QTableWidgetItem());
+    }
+
+    m_summaryLabel->clear();
+    updateInterface();
+}
+
+QStringList BuildMatrixDialog::selectedTargets()
+{
+    QStringList list;
+    for(int r = 0; r < m_table->rowCount(); r++)
+    {
+        QTableWidgetItem *item = m_table->item(r, ColumnTarget);
+        if(item->checkState() == Qt::Checked)
+            list.append(item->text());
+    }
+    return list;
+}
+
+void BuildMatrixDialog::slotBuild()
+{
+    QStringList targets = selectedTargets();
+    if(targets.isEmpty())
+        return;
+
+    for(int r = 0; r < m_table->rowCount(); r++)
+    {
+        m_table->item(r, ColumnStatus)->setText("");
+        m_table->item(r, ColumnFlash)->setText("");
+        m_table->item(r, ColumnRam)->setText("");
+    }
+    m_summaryLabel->clear();
+
+    emit buildRequested(targets);
+    updateInterface();
+}
+
+void BuildMatrixDialog::slotStateChanged(const QString &target, int state)
+{
+    int r = row(target);
+    if(r == -1)
+        return;
+
+    QString text;
+    switch(state)
+    {
+    case BuildMatrix::Waiting:  text = tr("Waiting"); break;
+    case BuildMatrix::Building: text = tr("Building..."); break;
+    case BuildMatrix::Passed:   text = tr("Passed"); break;
+    case BuildMatrix::Failed:   text = tr("Failed"); break;
+    default: ;
+    }
+
+    QTableWidgetItem *item = m_table->item(r, ColumnStatus);
+    item->setText(text);
+    if(state == BuildMatrix::Failed)
+        item->setForeground(QColor("#D8412E"));
+    else
+        item->setForeground(palette().color(QPalette::Text));
+
+    qint64 flash = m_matrix->flashSize(target);
+    qint64 ram = m_matrix->ramSize(target);
+    m_table->item(r, ColumnFlash)->setText(flash < 0 ? QString() : tr("%1 bytes").arg(flash));
+    m_table->item(r, ColumnRam)->setText(ram < 0 ? QString() : tr("%1 bytes").arg(ram));
+
+    updateInterface();
+}
+
+void BuildMatrixDialog::slotFinished()
+{
+    m_summaryLabel->setText(m_matrix->summary());
+    updateInterface();
+}
+
+void BuildMatrixDialog::slotShowOutput(int row, int column)
+{
+    Q_UNUSED(column);
+    QString target = m_table->item(row, ColumnTarget)->text();
+    QString output = m_matrix->output(target);
+    if(output.isEmpty())
+        return;
+
+    QMessageBox box(this);
+    box.setWindowTitle(target);
+    box.setText(tr("Build output for %1").arg(target));
+    box.setDetailedText(output);
+    box.exec();
+}
+
+int BuildMatrixDialog::row(const QString &target)
+{
+    for(int r = 0; r < m_table->rowCount(); r++)
+    {
+        if(m_table->item(r, ColumnTarget)->text() == target)
+            return r;
+    }
+    return -1;
+}
+
+void BuildMatrixDialog::updateInterface()
+{
+    bool running = m_matrix->isRunning();
+    m_buildButton->setEnabled(!running && m_table->rowCount() > 0);
+    m_abortButton->setEnabled(running);
+}
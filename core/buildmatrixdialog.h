@@ -0,0 +1,69 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUILDMATRIXDIALOG_H
+#define BUILDMATRIXDIALOG_H
+
+#include <QDialog>
+
+class BuildMatrix;
+class QTableWidget;
+class QPushButton;
+class QLabel;
+
+class BuildMatrixDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit BuildMatrixDialog(BuildMatrix *matrix, QWidget *parent = 0);
+
+    void setTargets(const QStringList &targets);
+    QStringList selectedTargets();
+
+signals:
+    void buildRequested(QStringList targets);
+
+private slots:
+    void slotBuild();
+    void slotStateChanged(const QString &target, int state);
+    void slotFinished();
+    void slotShowOutput(int row, int column);
+
+private:
+    enum Column
+    {
+        ColumnTarget = 0,
+        ColumnStatus,
+        ColumnFlash,
+        ColumnRam
+    };
+
+    BuildMatrix *m_matrix;
+
+    QTableWidget *m_table;
+    QLabel *m_summaryLabel;
+    QPushButton *m_buildButton;
+    QPushButton *m_abortButton;
+    QPushButton *m_closeButton;
+
+    int row(const QString &target);
+    void updateInterface();
+};
+
+#endif // BUILDMATRIXDIALOG_H
@@ -0,0 +1,311 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "editjournal.h"
+#include "applog.h"
+#include "textfile.h"
+
+#include <QDebug>
+#include <QTimer>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+
+static const char journalMagic[] = "QKJN";
+
+EditJournal::EditJournal(QObject *parent) :
+    QObject(parent),
+    m_busy(false),
+    m_timer(0)
+{
+}
+
+void EditJournal::start()
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(FlushDelay);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(slotFlush()));
+}
+
+void EditJournal::setFile(const QString &filePath)
+{
+    Command command;
+    command.type = CommandSetFile;
+    command.text = filePath;
+    append(command);
+}
+
+void EditJournal::close()
+{
+    Command command;
+    command.type = CommandClose;
+    append(command);
+}
+
+void EditJournal::open(const QString &pageName, const QString &text)
+{
+    Command command;
+    command.type = CommandOpen;
+    command.name = pageName;
+    command.text = text;
+    append(command);
+}
+
+void EditJournal::edit(const QString &pageName, int position, int charsRemoved,
+                       const QString &text)
+{
+    Command command;
+    command.type = CommandEdit;
+    command.name = pageName;
+    command.position = position;
+    command.charsRemoved = charsRemoved;
+    command.text = text;
+    append(command);
+}
+
+void EditJournal::saved(const QString &pageName, const QString &text)
+{
+    Command command;
+    command.type = CommandSaved;
+    command.name = pageName;
+    command.text = text;
+    append(command);
+}
+
+bool EditJournal::waitForIdle(int msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    if(m_busy)
+        QMetaObject::invokeMethod(this, "slotFlush", Qt::QueuedConnection);
+    while(m_busy)
+    {
+        if(!m_idle.wait(&m_mutex, msecs))
+            return false;
+    }
+    return true;
+}
+
+void EditJournal::append(const Command &command)
+{
+    QMutexLocker locker(&m_mutex);
+    m_commands.append(command);
+    if(!m_busy)
+    {
+        m_busy = true;
+        QMetaObject::invokeMethod(this, "slotSchedule", Qt::QueuedConnection);
+    }
+}
+
+void EditJournal::slotSchedule()
+{
+    if(!m_timer->isActive())
+        m_timer->start();
+}
+
+void EditJournal::slotFlush()
+{
+    m_timer->stop();
+
+    m_mutex.lock();
+    QList<Command> commands = m_commands;
+    m_commands.clear();
+    m_mutex.unlock();
+
+    foreach(const Command &command, commands)
+        process(command);
+    if(m_file.isOpen())
+        m_file.flush();
+
+    m_mutex.lock();
+    if(m_commands.isEmpty())
+    {
+        m_busy = false;
+        m_idle.wakeAll();
+    }
+    else
+        m_timer->start();
+    m_mutex.unlock();
+}
+
+void EditJournal::process(const Command &command)
+{
+    switch(command.type)
+    {
+    case CommandSetFile:
+        m_file.close();
+        m_bases.clear();
+        m_dirty.clear();
+        m_file.setFileName(command.text);
+        reset();
+        break;
+    case CommandClose:
+        // the user either saved or discarded the changes
+        if(m_file.isOpen())
+        {
+            m_file.close();
+            m_file.remove();
+        }
+        m_bases.clear();
+        m_dirty.clear();
+        break;
+    case CommandOpen:
+    case CommandSaved:
+    {
+        QByteArray base = hash(command.text);
+        m_bases.insert(command.name, base);
+        bool wasDirty = m_dirty.remove(command.name);
+        if(wasDirty && m_dirty.isEmpty())
+            reset();
+        else
+            writeBase(command.name, base);
+        break;
+    }
+    case CommandEdit:
+    {
+        if(!m_file.isOpen() || !m_bases.contains(command.name))
+            break;
+        QDataStream out(&m_file);
+        out.setVersion(QDataStream::Qt_5_0);
+        out << (quint8) RecordEdit << command.name << (qint32) command.position
+            << (qint32) command.charsRemoved << command.text;
+        m_dirty.insert(command.name);
+        break;
+    }
+    }
+}
+
+void EditJournal::reset()
+{
+    // start over with just the current base of every page
+    if(m_file.isOpen())
+        m_file.close();
+    if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "can't open journal" << m_file.fileName() << m_file.errorString();
+        return;
+    }
+
+    QDataStream out(&m_file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out.writeRawData(journalMagic, 4);
+    out << (quint8) Version;
+
+    QHashIterator<QString, QByteArray> i(m_bases);
+    while(i.hasNext())
+    {
+        i.next();
+        writeBase(i.key(), i.value());
+    }
+}
+
+void EditJournal::writeBase(const QString &name, const QByteArray &hash)
+{
+    if(!m_file.isOpen())
+        return;
+    QDataStream out(&m_file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << (quint8) RecordBase << name << hash;
+}
+
+QByteArray EditJournal::hash(const QString &text)
+{
+    return QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1);
+}
+
+bool EditJournal::recover(const QString &filePath, const QString &projectPath,
+                          QHash<QString, QString> *texts)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    char magic[4];
+    quint8 version;
+    if(in.readRawData(magic, 4) != 4 || QByteArray(magic, 4) != journalMagic)
+        return false;
+    in >> version;
+    if(version != Version)
+        return false;
+
+    QHash<QString, QByteArray> bases;
+    QHash<QString, QList<Edit> > edits;
+
+    // a record cut short by a crash ends the stream
+    forever
+    {
+        quint8 type;
+        QString name;
+        in >> type >> name;
+        if(in.status() != QDataStream::Ok)
+            break;
+
+        if(type == RecordBase)
+        {
+            QByteArray base;
+            in >> base;
+            if(in.status() != QDataStream::Ok)
+                break;
+            bases.insert(name, base);
+            edits.remove(name);
+        }
+        else if(type == RecordEdit)
+        {
+            Edit edit;
+            in >> edit.position >> edit.charsRemoved >> edit.text;
+            if(in.status() != QDataStream::Ok)
+                break;
+            edits[name].append(edit);
+        }
+        else
+            break;
+    }
+
+    QHashIterator<QString, QList<Edit> > i(edits);
+    while(i.hasNext())
+    {
+        i.next();
+
+        QString text;
+        if(!TextFile::read(projectPath + i.key(), &text) ||
+           hash(text) != bases.value(i.key()))
+        {
+            qkLog(Project) << "journal doesn't match" << i.key() << "anymore";
+            continue;
+        }
+
+        bool ok = true;
+        foreach(const Edit &edit, i.value())
+        {
+            if(edit.position < 0 || edit.position + edit.charsRemoved > text.size())
+            {
+                ok = false;
+                break;
+            }
+            text.replace(edit.position, edit.charsRemoved, edit.text);
+        }
+        if(ok)
+            texts->insert(i.key(), text);
+    }
+
+    return !texts->isEmpty();
+}
@@ -0,0 +1,118 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+
+class QTimer;
+
+/*
+ * Append-only log of the edits made to the pages of a project, written in
+ * batches from a worker thread. Every page starts with a base record that
+ * holds the hash of the text it was loaded from, so the edits can be
+ * replayed over the file on disk after a crash. Once all pages are saved
+ * the journal is truncated. Create it without parent, move it to a QThread
+ * and connect the thread's started() signal to start().
+ */
+class EditJournal : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EditJournal(QObject *parent = 0);
+
+    void setFile(const QString &filePath);
+    void close();
+    void open(const QString &pageName, const QString &text);
+    void edit(const QString &pageName, int position, int charsRemoved, const QString &text);
+    void saved(const QString &pageName, const QString &text);
+    bool waitForIdle(int msecs = 30000);
+
+    static bool recover(const QString &filePath, const QString &projectPath,
+                        QHash<QString, QString> *texts);
+
+public slots:
+    void start();
+
+private slots:
+    void slotSchedule();
+    void slotFlush();
+
+private:
+    enum
+    {
+        FlushDelay = 500,
+        Version = 1
+    };
+    enum RecordType
+    {
+        RecordBase = 1,
+        RecordEdit = 2
+    };
+    enum CommandType
+    {
+        CommandSetFile,
+        CommandClose,
+        CommandOpen,
+        CommandEdit,
+        CommandSaved
+    };
+    class Edit
+    {
+    public:
+        qint32 position;
+        qint32 charsRemoved;
+        QString text;
+    };
+    class Command
+    {
+    public:
+        CommandType type;
+        QString name;
+        int position;
+        int charsRemoved;
+        QString text;
+    };
+
+    QMutex m_mutex;
+    QWaitCondition m_idle;
+    QList<Command> m_commands;
+    bool m_busy;
+
+    QTimer *m_timer;
+    QFile m_file;
+    QHash<QString, QByteArray> m_bases;
+    QSet<QString> m_dirty;
+
+    void append(const Command &command);
+    void process(const Command &command);
+    void reset();
+    void writeBase(const QString &name, const QByteArray &hash);
+
+    static QByteArray hash(const QString &text);
+};
+
+#endif // EDITJOURNAL_H
@@ -0,0 +1,427 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "eventrecorder.h"
+#include "editor/editor.h"
+#include "editor/page.h"
+#include "editor/completer.h"
+
+#include <QDebug>
+#include <QApplication>
+#include <QAbstractItemView>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QFocusEvent>
+#include <QSaveFile>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+EventRecorder::EventRecorder(Editor *editor, QObject *parent) :
+    QObject(parent),
+    m_editor(editor),
+    m_recording(false),
+    m_replaying(false),
+    m_pausedTime(0),
+    m_pausedCpuTime(0),
+    m_next(0),
+    m_replayPage(0),
+    m_cpuTime(0),
+    m_wallTime(0)
+{
+}
+
+bool EventRecorder::startRecording(const QString &filePath)
+{
+    if(m_recording || m_replaying)
+        return false;
+
+    m_filePath = filePath;
+    m_records.clear();
+    m_recording = true;
+    m_clock.start();
+
+    QString projectPath = m_projectPath;
+    m_projectPath.clear();
+    setProject(projectPath);
+
+    qApp->installEventFilter(this);
+    return true;
+}
+
+bool EventRecorder::stopRecording()
+{
+    if(!m_recording)
+        return false;
+
+    qApp->removeEventFilter(this);
+    m_recording = false;
+
+    QSaveFile file(m_filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qDebug() << "unable to write events:" << m_filePath << file.errorString();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out << "qkevents " << Version << "\n";
+    foreach(const Record &r, m_records)
+    {
+        out << r.time << '\t' << r.type << '\t' << r.target << '\t'
+            << r.name.toUtf8().toPercentEncoding() << '\t'
+            << r.key << '\t' << r.modifiers << '\t'
+            << r.text.toUtf8().toPercentEncoding() << '\t'
+            << (r.autoRepeat ? 1 : 0) << '\t'
+            << r.pos.x() << '\t' << r.pos.y() << '\t'
+            << r.button << '\t' << r.buttons << '\t' << r.delta << '\n';
+    }
+    out.flush();
+
+    qDebug() << "recorded" << m_records.count() << "events to" << m_filePath;
+    return file.commit();
+}
+
+void EventRecorder::setProject(const QString &filePath)
+{
+    if(filePath == m_projectPath)
+        return;
+    m_projectPath = filePath;
+
+    if(m_recording && !filePath.isEmpty())
+    {
+        Record record;
+        record.time = m_clock.elapsed();
+        record.type = ProjectRecord;
+        record.target = TargetPage;
+        record.name = filePath;
+        record.key = record.modifiers = record.button = record.buttons = record.delta = 0;
+        record.autoRepeat = false;
+        m_records.append(record);
+    }
+}
+
+bool EventRecorder::eventFilter(QObject *watched, QEvent *event)
+{
+    switch(event->type())
+    {
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+        break;
+    default:
+        return false;
+    }
+
+    Page *page = qobject_cast<Page*>(watched);
+    int target = TargetPage;
+    if(page == 0)
+    {
+        page = qobject_cast<Page*>(watched->parent());
+        target = TargetViewport;
+        if(page != 0 && watched != page->viewport())
+            return false;
+    }
+    if(page == 0 && qobject_cast<QAbstractItemView*>(watched) != 0)
+    {
+        // completion popups grab the keyboard while they are shown
+        page = qobject_cast<Page*>(QApplication::focusWidget());
+        target = TargetPopup;
+        if(page != 0 && page->completer()->popup() != watched)
+            return false;
+    }
+    if(page == 0)
+        return false;
+
+    Record record;
+    record.time = m_clock.elapsed();
+    record.type = event->type();
+    record.target = target;
+    record.name = page->name();
+    record.key = 0;
+    record.modifiers = 0;
+    record.autoRepeat = false;
+    record.button = 0;
+    record.buttons = 0;
+    record.delta = 0;
+
+    if(event->type() == QEvent::KeyPress || event->type() == QEvent::KeyRelease)
+    {
+        QKeyEvent *e = static_cast<QKeyEvent*>(event);
+        record.key = e->key();
+        record.modifiers = e->modifiers();
+        record.text = e->text();
+        record.autoRepeat = e->isAutoRepeat();
+    }
+    else if(event->type() == QEvent::Wheel)
+    {
+        QWheelEvent *e = static_cast<QWheelEvent*>(event);
+        record.modifiers = e->modifiers();
+        record.pos = e->pos();
+        record.buttons = e->buttons();
+        record.delta = e->delta();
+    }
+    else
+    {
+        QMouseEvent *e = static_cast<QMouseEvent*>(event);
+        // plain hovering is noise, only drags are kept
+        if(event->type() == QEvent::MouseMove && e->buttons() == Qt::NoButton)
+            return false;
+        record.modifiers = e->modifiers();
+        record.pos = e->pos();
+        record.button = e->button();
+        record.buttons = e->buttons();
+    }
+
+    m_records.append(record);
+    return false;
+}
+
+bool EventRecorder::startReplay(const QString &filePath)
+{
+    if(m_recording || m_replaying || !load(filePath))
+        return false;
+
+    m_replaying = true;
+    m_next = 0;
+    m_pausedTime = 0;
+    m_pausedCpuTime = 0;
+    m_replayPage = 0;
+    m_latencies.clear();
+    m_keyLatencies.clear();
+    m_cpuTime = cpuTime();
+    m_clock.start();
+
+    QTimer::singleShot(0, this, SLOT(slotReplayNext()));
+    return true;
+}
+
+bool EventRecorder::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "unable to open events:" << filePath << file.errorString();
+        return false;
+    }
+
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    if(in.readLine() != QString("qkevents %1").arg(Version))
+    {
+        qDebug() << "not an event recording:" << filePath;
+        return false;
+    }
+
+    m_records.clear();
+    while(!in.atEnd())
+    {
+        QStringList fields = in.readLine().split('\t');
+        if(fields.count() != 13)
+            continue;
+
+        Record record;
+        record.time = fields[0].toLongLong();
+        record.type = fields[1].toInt();
+        record.target = fields[2].toInt();
+        record.name = QString::fromUtf8(QByteArray::fromPercentEncoding(fields[3].toLatin1()));
+        record.key = fields[4].toInt();
+        record.modifiers = fields[5].toInt();
+        record.text = QString::fromUtf8(QByteArray::fromPercentEncoding(fields[6].toLatin1()));
+        record.autoRepeat = fields[7].toInt() != 0;
+        record.pos = QPoint(fields[8].toInt(), fields[9].toInt());
+        record.button = fields[10].toInt();
+        record.buttons = fields[11].toInt();
+        record.delta = fields[12].toInt();
+        m_records.append(record);
+    }
+
+    m_filePath = filePath;
+    return true;
+}
+
+void EventRecorder::slotReplayNext()
+{
+    while(m_next < m_records.count())
+    {
+        const Record &record = m_records.at(m_next);
+
+        // keep the recorded pauses, timers like the parser's depend on them
+        qint64 wait = record.time - (m_clock.elapsed() - m_pausedTime);
+        if(wait > 0)
+        {
+            QTimer::singleShot(wait, this, SLOT(slotReplayNext()));
+            return;
+        }
+        m_next++;
+
+        if(record.type == ProjectRecord)
+        {
+            // opening a project is not part of the measurement
+            QElapsedTimer openTimer;
+            openTimer.start();
+            qint64 openCpuTime = cpuTime();
+            m_replayPage = 0;
+            emit projectRequested(record.name);
+            QApplication::processEvents();
+            m_pausedTime += openTimer.elapsed();
+            m_pausedCpuTime += cpuTime() - openCpuTime;
+            continue;
+        }
+
+        QElapsedTimer latency;
+        latency.start();
+        if(!send(record))
+            continue;
+        QApplication::processEvents();
+        qint64 elapsed = latency.nsecsElapsed();
+
+        m_latencies.append(elapsed);
+        if(record.type == QEvent::KeyPress)
+            m_keyLatencies.append(elapsed);
+    }
+
+    m_wallTime = m_clock.elapsed() - m_pausedTime;
+    m_cpuTime = cpuTime() - m_cpuTime - m_pausedCpuTime;
+    m_replaying = false;
+    emit replayFinished();
+}
+
+Page* EventRecorder::replayPage(const QString &name)
+{
+    if(m_replayPage != 0 && m_replayPage->name() == name)
+        return m_replayPage;
+
+    int index = m_editor->hasPage(name);
+    if(index == -1)
+        return 0;
+
+    Page *page = m_editor->loadPage(index);
+    if(page == 0)
+        return 0;
+    m_editor->setCurrentPage(index);
+
+    // the window may never be active on a headless display
+    page->setFocus();
+    QFocusEvent focusIn(QEvent::FocusIn, Qt::OtherFocusReason);
+    QApplication::sendEvent(page, &focusIn);
+
+    m_replayPage = page;
+    return page;
+}
+
+bool EventRecorder::send(const Record &record)
+{
+    Page *page = replayPage(record.name);
+    if(page == 0)
+        return false;
+
+    QObject *receiver = page;
+    if(record.target == TargetViewport)
+        receiver = page->viewport();
+    else if(record.target == TargetPopup && page->completer()->popup()->isVisible())
+        receiver = page->completer()->popup();
+
+    QEvent::Type type = (QEvent::Type)record.type;
+    Qt::KeyboardModifiers modifiers = (Qt::KeyboardModifiers)record.modifiers;
+
+    if(type == QEvent::KeyPress || type == QEvent::KeyRelease)
+    {
+        QKeyEvent event(type, record.key, modifiers, record.text, record.autoRepeat);
+        QApplication::sendEvent(receiver, &event);
+    }
+    else if(type == QEvent::Wheel)
+    {
+        QWheelEvent event(record.pos, record.delta, (Qt::MouseButtons)record.buttons, modifiers);
+        QApplication::sendEvent(receiver, &event);
+    }
+    else
+    {
+        QMouseEvent event(type, QPointF(record.pos), (Qt::MouseButton)record.button,
+                          (Qt::MouseButtons)record.buttons, modifiers);
+        QApplication::sendEvent(receiver, &event);
+    }
+    return true;
+}
+
+QString EventRecorder::report()
+{
+    QString text;
+    QTextStream out(&text);
+    out << "replay of " << m_filePath << "\n";
+    out << "events: " << m_latencies.count()
+        << " (" << m_keyLatencies.count() << " key presses)\n";
+    out << "wall time: " << m_wallTime << " ms\n";
+    out << "cpu time: " << m_cpuTime << " ms";
+    if(m_wallTime > 0)
+        out << " (" << m_cpuTime * 100 / m_wallTime << "%)";
+    out << "\n\n";
+    out << percentiles("all events", m_latencies);
+    out << percentiles("key presses", m_keyLatencies);
+    return text;
+}
+
+QString EventRecorder::percentiles(const QString &title, QVector<qint64> latencies)
+{
+    if(latencies.isEmpty())
+        return QString();
+
+    qSort(latencies);
+    int count = latencies.count();
+    QString line = QString("%1").arg(title, -12);
+    int percents[] = { 50, 90, 99 };
+    for(int i = 0; i < 3; i++)
+    {
+        qint64 ns = latencies.at(qMin(count - 1, count * percents[i] / 100));
+        line += QString("  p%1 %2 ms").arg(percents[i]).arg(ns / 1e6, 0, 'f', 3);
+    }
+    line += QString("  max %1 ms\n").arg(latencies.last() / 1e6, 0, 'f', 3);
+    return line;
+}
+
+qint64 EventRecorder::cpuTime()
+{
+    // user + system time of all the threads, in ms
+#ifdef Q_OS_WIN
+    FILETIME creation, exit, kernel, user;
+    if(!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+    quint64 k = ((quint64)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    quint64 u = ((quint64)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return (k + u) / 10000;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return (qint64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#endif
+}
@@ -0,0 +1,119 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTRECORDER_H
+#define EVENTRECORDER_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QPoint>
+#include <QElapsedTimer>
+
+class Editor;
+class Page;
+
+/*
+ * Records the key and mouse events that reach the editor pages, with their
+ * timing and the project they were typed in, and replays them against the
+ * live widgets. During a replay every event is sent synchronously and the
+ * time until the event queue is drained again is taken as its latency.
+ */
+class EventRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EventRecorder(Editor *editor, QObject *parent = 0);
+
+    bool startRecording(const QString &filePath);
+    bool stopRecording();
+    bool isRecording() { return m_recording; }
+
+    bool startReplay(const QString &filePath);
+    bool isReplaying() { return m_replaying; }
+    QString report();
+
+signals:
+    void projectRequested(QString filePath);
+    void replayFinished();
+
+public slots:
+    void setProject(const QString &filePath);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event);
+
+private slots:
+    void slotReplayNext();
+
+private:
+    enum
+    {
+        Version = 1,
+        ProjectRecord = 0
+    };
+    enum Target
+    {
+        TargetPage = 0,
+        TargetViewport,
+        TargetPopup
+    };
+    class Record
+    {
+    public:
+        qint64 time;
+        int type;
+        int target;
+        QString name;
+        int key;
+        int modifiers;
+        QString text;
+        bool autoRepeat;
+        QPoint pos;
+        int button;
+        int buttons;
+        int delta;
+    };
+
+    Editor *m_editor;
+    QString m_filePath;
+    QString m_projectPath;
+    QList<Record> m_records;
+    bool m_recording;
+    bool m_replaying;
+
+    QElapsedTimer m_clock;
+    qint64 m_pausedTime;
+    qint64 m_pausedCpuTime;
+    int m_next;
+    Page *m_replayPage;
+    QVector<qint64> m_latencies;
+    QVector<qint64> m_keyLatencies;
+    qint64 m_cpuTime;
+    qint64 m_wallTime;
+
+    bool load(const QString &filePath);
+    Page* replayPage(const QString &name);
+    bool send(const Record &record);
+
+    static qint64 cpuTime();
+    static QString percentiles(const QString &title, QVector<qint64> latencies);
+};
+
+#endif // EVENTRECORDER_H
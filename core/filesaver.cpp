@@ -0,0 +1,122 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filesaver.h"
+
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+
+FileSaver::FileSaver(QObject *parent) :
+    QObject(parent),
+    m_busy(false)
+{
+}
+
+void FileSaver::save(const QString &filePath, const QString &text, int revision)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(!m_pending.contains(filePath))
+        m_queue.append(filePath);
+
+    Request request;
+    request.text = text;
+    request.revision = revision;
+    m_pending.insert(filePath, request);
+
+    if(!m_busy)
+    {
+        m_busy = true;
+        QMetaObject::invokeMethod(this, "slotFlush", Qt::QueuedConnection);
+    }
+}
+
+bool FileSaver::waitForIdle(int msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    while(m_busy)
+    {
+        if(!m_idle.wait(&m_mutex, msecs))
+            return false;
+    }
+    return true;
+}
+
+void FileSaver::slotFlush()
+{
+    forever
+    {
+        m_mutex.lock();
+        if(m_queue.isEmpty())
+        {
+            m_busy = false;
+            m_idle.wakeAll();
+            m_mutex.unlock();
+            return;
+        }
+        QString filePath = m_queue.takeFirst();
+        Request request = m_pending.take(filePath);
+        m_mutex.unlock();
+
+        QString errorString;
+        if(write(filePath, request.text, &errorString))
+            emit saved(filePath, request.revision);
+        else
+            emit error(filePath, errorString);
+    }
+}
+
+bool FileSaver::write(const QString &filePath, const QString &text, QString *errorString)
+{
+    QByteArray data = text.toUtf8();
+    QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    QFileInfo info(filePath);
+    if(m_written.contains(filePath) && info.exists())
+    {
+        const Written &last = m_written[filePath];
+        if(last.hash == hash && last.size == info.size() &&
+           last.modified == info.lastModified())
+            return true;
+    }
+
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        *errorString = file.errorString();
+        return false;
+    }
+    if(file.write(data) != data.size() || !file.commit())
+    {
+        *errorString = file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+
+    info.refresh();
+    Written written;
+    written.hash = hash;
+    written.size = info.size();
+    written.modified = info.lastModified();
+    m_written.insert(filePath, written);
+
+    return true;
+}
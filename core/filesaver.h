@@ -0,0 +1,78 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILESAVER_H
+#define FILESAVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include <QDateTime>
+#include <QMutex>
+#include <QWaitCondition>
+
+/*
+ * Writes files from a worker thread. save() may be called from any thread,
+ * only the latest text queued for a path is written and files whose content
+ * did not change since the last write are skipped. Each write goes to a
+ * temporary file which is synced and renamed over the original.
+ */
+class FileSaver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileSaver(QObject *parent = 0);
+
+    void save(const QString &filePath, const QString &text, int revision);
+    bool waitForIdle(int msecs = 30000);
+
+signals:
+    void saved(QString filePath, int revision);
+    void error(QString filePath, QString message);
+
+private slots:
+    void slotFlush();
+
+private:
+    class Request
+    {
+    public:
+        QString text;
+        int revision;
+    };
+    class Written
+    {
+    public:
+        QByteArray hash;
+        qint64 size;
+        QDateTime modified;
+    };
+
+    QMutex m_mutex;
+    QWaitCondition m_idle;
+    QHash<QString, Request> m_pending;
+    QStringList m_queue;
+    bool m_busy;
+
+    QHash<QString, Written> m_written;
+
+    bool write(const QString &filePath, const QString &text, QString *errorString);
+};
+
+#endif // FILESAVER_H
@@ -0,0 +1,451 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "occurrenceindex.h"
+#include "applog.h"
+#include "textfile.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QTimer>
+#include <QElapsedTimer>
+
+static const char cacheMagic[] = "QKXR";
+
+OccurrenceIndex::OccurrenceIndex(const QString &cacheFile, QObject *parent) :
+    QObject(parent),
+    m_ready(false),
+    m_cacheFile(cacheFile),
+    m_saveTimer(0)
+{
+    qRegisterMetaType<SearchMatch>("SearchMatch");
+    qRegisterMetaType<QList<SearchMatch> >("QList<SearchMatch>");
+}
+
+bool OccurrenceIndex::isReady()
+{
+    QReadLocker locker(&m_lock);
+    return m_ready;
+}
+
+int OccurrenceIndex::count(const QString &symbol)
+{
+    QReadLocker locker(&m_lock);
+    return m_symbols.value(symbol).count();
+}
+
+int OccurrenceIndex::callCount(const QString &symbol)
+{
+    QReadLocker locker(&m_lock);
+    int calls = 0;
+    foreach(const Entry &entry, m_symbols.value(symbol))
+        if(entry.call)
+            calls++;
+    return calls;
+}
+
+QList<Occurrence> OccurrenceIndex::occurrences(const QString &symbol, bool callsOnly)
+{
+    QReadLocker locker(&m_lock);
+    QList<Occurrence> result;
+    foreach(const Entry &entry, m_symbols.value(symbol))
+    {
+        if(callsOnly && !entry.call)
+            continue;
+        Occurrence occurrence;
+        occurrence.filePath = m_files.at(entry.file).path;
+        occurrence.line = entry.line;
+        occurrence.call = entry.call;
+        result.append(occurrence);
+    }
+    return result;
+}
+
+void OccurrenceIndex::start()
+{
+    m_saveTimer = new QTimer(this);
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(SaveDelay);
+    connect(m_saveTimer, SIGNAL(timeout()), this, SLOT(slotSave()));
+
+    load();
+}
+
+void OccurrenceIndex::setRoots(const QStringList &roots)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_roots.clear();
+    foreach(QString root, roots)
+        m_roots.append(QDir::cleanPath(root));
+
+    QSet<QString> found;
+    int changed = 0;
+    foreach(QString root, m_roots)
+    {
+        QDirIterator it(root, QDir::Files, QDirIterator::Subdirectories);
+        while(it.hasNext())
+        {
+            QString path = it.next();
+            if(!isSource(path))
+                continue;
+            found.insert(path);
+
+            QFileInfo info(path);
+            int id;
+            {
+                QReadLocker locker(&m_lock);
+                id = m_ids.value(path, -1);
+                if(id != -1 && m_files.at(id).size == info.size() &&
+                   m_files.at(id).modified == info.lastModified())
+                    continue;
+            }
+            indexFile(path);
+            changed++;
+        }
+    }
+
+    {
+        QWriteLocker locker(&m_lock);
+        foreach(QString path, m_ids.keys())
+        {
+            if(!found.contains(path))
+            {
+                removeFile(m_ids.value(path));
+                changed++;
+            }
+        }
+        m_ready = true;
+    }
+
+    qkLog(Project) << "occurrence index:" << found.count() << "files," << changed <<
+                "updated in" << timer.elapsed() << "ms";
+
+    if(changed > 0)
+        m_saveTimer->start();
+    emit updated();
+}
+
+void OccurrenceIndex::updateFile(const QString &filePath)
+{
+    QString path = QDir::cleanPath(filePath);
+
+    bool inRoots = false;
+    foreach(QString root, m_roots)
+        if(path.startsWith(root + "/"))
+            inRoots = true;
+    if(!inRoots || !isSource(path))
+        return;
+
+    indexFile(path);
+    m_saveTimer->start();
+    emit updated();
+}
+
+void OccurrenceIndex::findPreviews(int id, const QString &symbol, bool callsOnly)
+{
+    // the line texts are read here, a file at a time, and streamed back
+    QList<Occurrence> list = occurrences(symbol, callsOnly);
+    QList<SearchMatch> matches;
+    QStringList lines;
+    int count = 0;
+
+    for(int i = 0; i < list.count(); i++)
+    {
+        const Occurrence &occurrence = list.at(i);
+        if(i == 0 || occurrence.filePath != list.at(i - 1).filePath)
+        {
+            if(m_currentPreview.load() != id)
+                return;
+            QString text;
+            TextFile::read(occurrence.filePath, &text);
+            lines = text.split('\n');
+        }
+
+        SearchMatch match;
+        match.filePath = occurrence.filePath;
+        match.line = occurrence.line;
+        match.text = lines.value(occurrence.line - 1).trimmed();
+        match.column = qMax(0, lines.value(occurrence.line - 1).indexOf(symbol));
+        matches.append(match);
+
+        if(i + 1 == list.count() || list.at(i + 1).filePath != occurrence.filePath)
+        {
+            count += matches.count();
+            emit previewsFound(id, matches);
+            matches.clear();
+        }
+    }
+
+    emit previewsFinished(id, count);
+}
+
+void OccurrenceIndex::slotSave()
+{
+    QSaveFile file(m_cacheFile);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "can't save occurrence index" << file.errorString();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out.writeRawData(cacheMagic, 4);
+    out << (quint8) Version;
+
+    {
+        QReadLocker locker(&m_lock);
+        out << (qint32) m_ids.count();
+        foreach(int id, m_ids)
+        {
+            const File &f = m_files.at(id);
+            out << f.path << f.size << f.modified << (qint32) f.tokens.count();
+            foreach(const Token &token, f.tokens)
+                out << token.name << token.line << token.call;
+        }
+    }
+
+    if(!file.commit())
+        qDebug() << "can't save occurrence index" << file.errorString();
+}
+
+void OccurrenceIndex::load()
+{
+    QFile file(m_cacheFile);
+    if(!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    char magic[4];
+    quint8 version;
+    if(in.readRawData(magic, 4) != 4 || QByteArray(magic, 4) != cacheMagic)
+        return;
+    in >> version;
+    if(version != Version)
+        return;
+
+    qint32 fileCount;
+    in >> fileCount;
+
+    QWriteLocker locker(&m_lock);
+    for(int i = 0; i < fileCount && in.status() == QDataStream::Ok; i++)
+    {
+        File f;
+        qint32 tokenCount;
+        in >> f.path >> f.size >> f.modified >> tokenCount;
+        f.tokens.resize(qMax(0, tokenCount));
+        for(int t = 0; t < f.tokens.count(); t++)
+            in >> f.tokens[t].name >> f.tokens[t].line >> f.tokens[t].call;
+        if(in.status() == QDataStream::Ok)
+            addFile(f);
+    }
+}
+
+void OccurrenceIndex::indexFile(const QString &path)
+{
+    QFileInfo info(path);
+
+    // tokenize before taking the lock, lookups go on meanwhile
+    File f;
+    f.path = path;
+    f.size = info.size();
+    f.modified = info.lastModified();
+    QString text;
+    if(info.size() <= MaxFileSize && TextFile::read(path, &text))
+        f.tokens = tokenize(text);
+
+    QWriteLocker locker(&m_lock);
+    int id = m_ids.value(path, -1);
+    if(id != -1)
+        removeFile(id);
+    if(info.exists())
+        addFile(f);
+}
+
+void OccurrenceIndex::addFile(const File &file)
+{
+    int id;
+    if(!m_freeIds.isEmpty())
+    {
+        id = m_freeIds.takeFirst();
+        m_files[id] = file;
+    }
+    else
+    {
+        id = m_files.count();
+        m_files.append(file);
+    }
+    m_ids.insert(file.path, id);
+
+    foreach(const Token &token, file.tokens)
+    {
+        Entry entry;
+        entry.file = id;
+        entry.line = token.line;
+        entry.call = token.call;
+        m_symbols[token.name].append(entry);
+    }
+}
+
+void OccurrenceIndex::removeFile(int id)
+{
+    File &file = m_files[id];
+
+    QSet<QString> names;
+    foreach(const Token &token, file.tokens)
+        names.insert(token.name);
+
+    foreach(QString name, names)
+    {
+        QVector<Entry> &entries = m_symbols[name];
+        QVector<Entry> kept;
+        kept.reserve(entries.count());
+        foreach(const Entry &entry, entries)
+            if(entry.file != id)
+                kept.append(entry);
+        if(kept.isEmpty())
+            m_symbols.remove(name);
+        else
+            entries = kept;
+    }
+
+    m_ids.remove(file.path);
+    file = File();
+    m_freeIds.append(id);
+}
+
+bool OccurrenceIndex::isSource(const QString &path)
+{
+    return path.endsWith(".c") || path.endsWith(".h") ||
+           path.endsWith(".cpp") || path.endsWith(".hpp");
+}
+
+QVector<OccurrenceIndex::Token> OccurrenceIndex::tokenize(const QString &text)
+{
+    static QSet<QString> keywords;
+    if(keywords.isEmpty())
+    {
+        keywords << "auto" << "break" << "case" << "char" << "const" << "continue"
+                 << "default" << "do" << "double" << "else" << "enum" << "extern"
+                 << "float" << "for" << "goto" << "if" << "inline" << "int" << "long"
+                 << "register" << "return" << "short" << "signed" << "sizeof"
+                 << "static" << "struct" << "switch" << "typedef" << "union"
+                 << "unsigned" << "void" << "volatile" << "while" << "define"
+                 << "include" << "ifdef" << "ifndef" << "endif" << "elif" << "defined"
+                 << "pragma" << "undef";
+    }
+
+    QVector<Token> tokens;
+    const QChar *data = text.constData();
+    int size = text.size();
+    int line = 1;
+    bool prevWord = false;
+    QString prevName;
+
+    int i = 0;
+    while(i < size)
+    {
+        QChar c = data[i];
+        if(c == '\n')
+        {
+            line++;
+            i++;
+        }
+        else if(c == '/' && i + 1 < size && data[i+1] == '/')
+        {
+            while(i < size && data[i] != '\n')
+                i++;
+        }
+        else if(c == '/' && i + 1 < size && data[i+1] == '*')
+        {
+            i += 2;
+            while(i < size && !(data[i] == '*' && i + 1 < size && data[i+1] == '/'))
+            {
+                if(data[i] == '\n')
+                    line++;
+                i++;
+            }
+            i += 2;
+        }
+        else if(c == '"' || c == '\'')
+        {
+            i++;
+            while(i < size && data[i] != c && data[i] != '\n')
+            {
+                if(data[i] == '\\')
+                    i++;
+                i++;
+            }
+            i++;
+            prevWord = false;
+        }
+        else if(c.isLetter() || c == '_')
+        {
+            int start = i;
+            while(i < size && (data[i].isLetterOrNumber() || data[i] == '_'))
+                i++;
+            QString name = QString(data + start, i - start);
+
+            if(name == "include")
+            {
+                // header names are not identifiers
+                while(i < size && data[i] != '\n')
+                    i++;
+            }
+            else if(!keywords.contains(name))
+            {
+                int j = i;
+                while(j < size && (data[j] == ' ' || data[j] == '\t'))
+                    j++;
+
+                // "type name(" declares, "name(" after anything else calls
+                Token token;
+                token.name = name;
+                token.line = line;
+                token.call = (j < size && data[j] == '(') &&
+                             !(prevWord && prevName != "return" && prevName != "else");
+                tokens.append(token);
+            }
+            prevWord = true;
+            prevName = name;
+        }
+        else if(c.isDigit())
+        {
+            while(i < size && (data[i].isLetterOrNumber() || data[i] == '.'))
+                i++;
+            prevWord = false;
+        }
+        else
+        {
+            if(!c.isSpace())
+                prevWord = (c == '*' && prevWord);
+            i++;
+        }
+    }
+
+    return tokens;
+}
@@ -0,0 +1,127 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OCCURRENCEINDEX_H
+#define OCCURRENCEINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QStringList>
+#include <QDateTime>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include "searchindex.h"
+
+class QTimer;
+
+class Occurrence
+{
+public:
+    QString filePath;
+    int line;
+    bool call;
+};
+
+/*
+ * Identifier -> file/line table of the C sources under a set of folders.
+ * It is built and updated from a worker thread, saved to a cache file so
+ * only changed files are read again on the next run, and can be queried
+ * from any thread. Create it without parent, move it to a QThread and
+ * connect the thread's started() signal to start().
+ */
+class OccurrenceIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit OccurrenceIndex(const QString &cacheFile, QObject *parent = 0);
+
+    bool isReady();
+    int count(const QString &symbol);
+    int callCount(const QString &symbol);
+    QList<Occurrence> occurrences(const QString &symbol, bool callsOnly = false);
+    void setCurrentPreview(int id) { m_currentPreview.store(id); }
+
+signals:
+    void updated();
+    void previewsFound(int id, QList<SearchMatch> matches);
+    void previewsFinished(int id, int matches);
+
+public slots:
+    void start();
+    void setRoots(const QStringList &roots);
+    void updateFile(const QString &filePath);
+    void findPreviews(int id, const QString &symbol, bool callsOnly);
+
+private slots:
+    void slotSave();
+
+private:
+    enum
+    {
+        SaveDelay = 2000,
+        MaxFileSize = 4*1024*1024,
+        Version = 1
+    };
+    class Token
+    {
+    public:
+        QString name;
+        qint32 line;
+        bool call;
+    };
+    class Entry
+    {
+    public:
+        int file;
+        int line;
+        bool call;
+    };
+    class File
+    {
+    public:
+        QString path;
+        qint64 size;
+        QDateTime modified;
+        QVector<Token> tokens;
+    };
+
+    QReadWriteLock m_lock;
+    QVector<File> m_files;
+    QHash<QString, int> m_ids;
+    QList<int> m_freeIds;
+    QHash<QString, QVector<Entry> > m_symbols;
+    bool m_ready;
+
+    QString m_cacheFile;
+    QStringList m_roots;
+    QTimer *m_saveTimer;
+    QAtomicInt m_currentPreview;
+
+    void load();
+    void indexFile(const QString &path);
+    void addFile(const File &file);
+    void removeFile(int id);
+
+    static bool isSource(const QString &path);
+    static QVector<Token> tokenize(const QString &text);
+};
+
+#endif // OCCURRENCEINDEX_H
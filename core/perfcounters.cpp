@@ -0,0 +1,103 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "perfcounters.h"
+
+QAtomicInt PerfCounters::m_enabled;
+QAtomicInt PerfCounters::m_time[PerfCounters::CounterCount];
+QAtomicInt PerfCounters::m_calls[PerfCounters::CounterCount];
+QAtomicInt PerfCounters::m_gauges[PerfCounters::GaugeCount];
+QList<PerfCounters::Frame> PerfCounters::m_history;
+
+void PerfCounters::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled ? 1 : 0);
+    if(!enabled)
+    {
+        for(int i = 0; i < CounterCount; i++)
+        {
+            m_time[i].store(0);
+            m_calls[i].store(0);
+        }
+        m_history.clear();
+    }
+}
+
+void PerfCounters::add(Counter counter, qint64 nsecs)
+{
+    m_time[counter].fetchAndAddRelaxed((int)((nsecs + 500) / 1000));
+    m_calls[counter].fetchAndAddRelaxed(1);
+}
+
+void PerfCounters::setGauge(Gauge gauge, int value)
+{
+    m_gauges[gauge].store(value);
+}
+
+int PerfCounters::gauge(Gauge gauge)
+{
+    return m_gauges[gauge].load();
+}
+
+void PerfCounters::keystroke()
+{
+    if(!isEnabled())
+        return;
+
+    Frame frame;
+    for(int i = 0; i < CounterCount; i++)
+    {
+        frame.time[i] = m_time[i].fetchAndStoreRelaxed(0);
+        frame.calls[i] = m_calls[i].fetchAndStoreRelaxed(0);
+    }
+
+    m_history.append(frame);
+    if(m_history.count() > HistorySize)
+        m_history.removeFirst();
+}
+
+PerfCounters::Frame PerfCounters::current()
+{
+    Frame frame;
+    for(int i = 0; i < CounterCount; i++)
+    {
+        frame.time[i] = m_time[i].load();
+        frame.calls[i] = m_calls[i].load();
+    }
+    return frame;
+}
+
+QList<PerfCounters::Frame> PerfCounters::history()
+{
+    return m_history;
+}
+
+QString PerfCounters::name(Counter counter)
+{
+    switch(counter)
+    {
+    case HighlightBlock:  return "highlightBlock";
+    case BraceMatch:      return "braceMatch";
+    case FunctionTooltip: return "setFunctionTooltip";
+    case CompleterFilter: return "completer filter";
+    case GutterPaint:     return "gutter paint";
+    case ParseCycle:      return "parse cycle";
+    default:              return QString();
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QString>
+#include <QList>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+/*
+ * Time spent per keystroke in the editor hot paths. Scopes only read the
+ * clock while counting is enabled, which the performance dock does while
+ * it is visible. Counters may be updated from any thread; keystroke(),
+ * current() and history() belong to the GUI thread.
+ */
+class PerfCounters
+{
+public:
+    enum Counter
+    {
+        HighlightBlock = 0,
+        BraceMatch,
+        FunctionTooltip,
+        CompleterFilter,
+        GutterPaint,
+        ParseCycle,         // CodeParser::parse, synchronous on the GUI thread
+        CounterCount
+    };
+    enum Gauge
+    {
+        SymbolsLoaded = 0,
+        GaugeCount
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(Counter counter) : m_counter(counter), m_active(PerfCounters::isEnabled())
+        {
+            if(m_active)
+                m_timer.start();
+        }
+        ~Scope()
+        {
+            if(m_active)
+                PerfCounters::add(m_counter, m_timer.nsecsElapsed());
+        }
+    private:
+        Counter m_counter;
+        bool m_active;
+        QElapsedTimer m_timer;
+    };
+
+    // what happened between two keystrokes, times in microseconds
+    class Frame
+    {
+    public:
+        int time[CounterCount];
+        int calls[CounterCount];
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return m_enabled.load() != 0; }
+
+    static void add(Counter counter, qint64 nsecs);
+    static void setGauge(Gauge gauge, int value);
+    static int gauge(Gauge gauge);
+
+    static void keystroke();
+    static Frame current();
+    static QList<Frame> history();
+    static QString name(Counter counter);
+
+private:
+    enum
+    {
+        HistorySize = 32
+    };
+
+    static QAtomicInt m_enabled;
+    static QAtomicInt m_time[CounterCount];
+    static QAtomicInt m_calls[CounterCount];
+    static QAtomicInt m_gauges[GaugeCount];
+    static QList<Frame> m_history;
+};
+
+#endif // PERFCOUNTERS_H
@@ -19,6 +19,7 @@
 
 #include "project.h"
 #include "qkide_global.h"
+#include "applog.h"
 
 #include <QDebug>
 #include <QDateTime>
@@ -62,7 +63,7 @@ void Project::addFile(const QString fileName)
 {
     if(hasFile(fileName)) return;
 
-    qDebug() << "project add file:" << fileName;
+    qkLog(Project) << "project add file:" << fileName;
     m_files.append(fileName);
 
     emit filesChanged();
@@ -72,7 +73,7 @@ void Project::removeFile(const QString fileName)
 {
     if(!hasFile(fileName)) return;
 
-    qDebug() << "project remove file:" << fileName;
+    qkLog(Project) << "project remove file:" << fileName;
     m_files.removeOne(fileName);
 
     emit filesChanged();
@@ -179,12 +180,12 @@ bool Project::loadFromFile(const QString path)
                     attrName = attr.name().toString();
                     if(attrName.compare("name") == 0) {
                         projectName = attr.value().toString();
-                        qDebug() << "project name:" << projectName;
+                        qkLog(Project) << "project name:" << projectName;
                     }
                     else if(attrName.compare("readOnly") == 0) {
                         var.setValue(attr.value().toString());
                         readOnly = var.toBool();
-                        qDebug() << "project readOnly:" << readOnly;
+                        qkLog(Project) << "project readOnly:" << readOnly;
                     }
                 }
             }
@@ -206,8 +207,8 @@ bool Project::loadFromFile(const QString path)
         m_name = projectName;
         projectPath = path;
         projectPath.chop(last.count());
-        qDebug() << "project NAME" << projectName;
-        qDebug() << "project PATH" << projectPath << path;
+        qkLog(Project) << "project NAME" << projectName;
+        qkLog(Project) << "project PATH" << projectPath << path;
         m_path = projectPath;
         m_readOnly = readOnly;
     }
@@ -221,7 +222,7 @@ bool Project::saveToFile(const QString filePath)
 {
     QVariant var;
 
-    qDebug() << "save project to file" << filePath;
+    qkLog(Project) << "save project to file" << filePath;
 
     if(filePath.isEmpty())
         return false;
@@ -246,7 +247,7 @@ bool Project::saveToFile(const QString filePath)
         foreach(QString name, m_files){
             stream.writeTextElement("file", name);
 
-            qDebug() << "project save file:" << name;
+            qkLog(Project) << "project save file:" << name;
         }
 
         stream.writeEndElement(); // bookmark
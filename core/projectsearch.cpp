@@ -0,0 +1,88 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "projectsearch.h"
+#include "applog.h"
+#include "textfile.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+ProjectSearch::ProjectSearch(QObject *parent) :
+    QObject(parent)
+{
+    qRegisterMetaType<SearchMatch>("SearchMatch");
+    qRegisterMetaType<QList<SearchMatch> >("QList<SearchMatch>");
+}
+
+void ProjectSearch::search(int id, const QStringList &roots, const QString &query,
+                           int flags, const QStringList &openPaths,
+                           const QStringList &openTexts)
+{
+    if(m_current.load() != id)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_index.setRoots(roots);
+    int changed = m_index.update();
+
+    Qt::CaseSensitivity cs = (flags & CaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    bool wholeWords = (flags & WholeWords);
+    int fileCount = 0;
+    int matchCount = 0;
+
+    // unsaved pages are searched as they are in the editor
+    for(int i = 0; i < openPaths.count(); i++)
+    {
+        QList<SearchMatch> matches = SearchIndex::match(openPaths[i], openTexts[i], query, cs, wholeWords);
+        if(!matches.isEmpty())
+        {
+            fileCount++;
+            matchCount += matches.count();
+            emit found(id, matches);
+        }
+    }
+
+    foreach(QString path, m_index.candidates(query))
+    {
+        if(m_current.load() != id)
+            return;
+        if(openPaths.contains(path))
+            continue;
+
+        QString text;
+        if(!TextFile::read(path, &text))
+            continue;
+
+        QList<SearchMatch> matches = SearchIndex::match(path, text, query, cs, wholeWords);
+        if(!matches.isEmpty())
+        {
+            fileCount++;
+            matchCount += matches.count();
+            emit found(id, matches);
+        }
+    }
+
+    qkLog(Project) << "search" << query << "took" << timer.elapsed() << "ms," <<
+                changed << "of" << m_index.fileCount() << "files reindexed";
+
+    emit finished(id, fileCount, matchCount);
+}
@@ -0,0 +1,60 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROJECTSEARCH_H
+#define PROJECTSEARCH_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include "searchindex.h"
+
+/*
+ * Runs searches over a SearchIndex from a worker thread and streams the
+ * matches file by file. Setting a new current search id from any thread
+ * makes a running search stop at the next file.
+ */
+class ProjectSearch : public QObject
+{
+    Q_OBJECT
+public:
+    enum Flag
+    {
+        CaseSensitive = 0x01,
+        WholeWords = 0x02
+    };
+
+    explicit ProjectSearch(QObject *parent = 0);
+
+    void setCurrent(int id) { m_current.store(id); }
+
+signals:
+    void found(int id, QList<SearchMatch> matches);
+    void finished(int id, int files, int matches);
+
+public slots:
+    void search(int id, const QStringList &roots, const QString &query,
+                int flags, const QStringList &openPaths,
+                const QStringList &openTexts);
+
+private:
+    SearchIndex m_index;
+    QAtomicInt m_current;
+};
+
+#endif // PROJECTSEARCH_H
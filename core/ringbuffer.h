@@ -0,0 +1,91 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+/*
+ * Lock-free ring buffer for exactly one producer thread and one
+ * consumer thread. Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(int capacity = 4096)
+    {
+        int size = 1;
+        while(size < capacity)
+            size <<= 1;
+        m_data.resize(size);
+        m_mask = size - 1;
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    int capacity() const { return m_data.size(); }
+
+    int count() const
+    {
+        return (int)((unsigned)m_head.loadAcquire() - (unsigned)m_tail.loadAcquire());
+    }
+
+    // producer side
+    bool push(const T &item)
+    {
+        unsigned head = (unsigned)m_head.load();
+        unsigned tail = (unsigned)m_tail.loadAcquire();
+        if(head - tail == (unsigned)m_data.size())
+            return false;
+        m_data[head & m_mask] = item;
+        m_head.storeRelease((int)(head + 1));
+        return true;
+    }
+
+    // consumer side
+    bool pop(T *item)
+    {
+        unsigned tail = (unsigned)m_tail.load();
+        unsigned head = (unsigned)m_head.loadAcquire();
+        if(head == tail)
+            return false;
+        *item = m_data[tail & m_mask];
+        m_tail.storeRelease((int)(tail + 1));
+        return true;
+    }
+
+    // consumer side, only safe while the producer is stopped
+    void clear()
+    {
+        m_tail.storeRelease(m_head.loadAcquire());
+    }
+
+private:
+    QVector<T> m_data;
+    unsigned m_mask;
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+
+    Q_DISABLE_COPY(RingBuffer)
+};
+
+#endif // RINGBUFFER_H
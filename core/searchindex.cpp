@@ -0,0 +1,265 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "searchindex.h"
+#include "textfile.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSet>
+
+SearchIndex::SearchIndex()
+{
+}
+
+void SearchIndex::setRoots(const QStringList &roots)
+{
+    m_roots.clear();
+    foreach(QString root, roots)
+        m_roots.append(QDir::cleanPath(root));
+}
+
+int SearchIndex::update()
+{
+    QStringList paths;
+    foreach(QString root, m_roots)
+        scan(root, &paths);
+
+    int changed = 0;
+    QSet<QString> found;
+    foreach(QString path, paths)
+    {
+        found.insert(path);
+
+        QFileInfo info(path);
+        int id = m_ids.value(path, -1);
+        if(id != -1)
+        {
+            const File &file = m_files.at(id);
+            if(file.size == info.size() && file.modified == info.lastModified())
+                continue;
+            removeFile(id);
+        }
+        addFile(path, info.size(), info.lastModified());
+        changed++;
+    }
+
+    foreach(QString path, m_ids.keys())
+    {
+        if(!found.contains(path))
+        {
+            removeFile(m_ids.value(path));
+            changed++;
+        }
+    }
+
+    return changed;
+}
+
+QStringList SearchIndex::candidates(const QString &query)
+{
+    QStringList paths;
+    QVector<quint64> keys = trigrams(query);
+
+    if(keys.isEmpty())
+    {
+        // too short to narrow anything down
+        paths = m_ids.keys();
+        paths.sort();
+        return paths;
+    }
+
+    // intersect starting with the rarest trigram
+    QVector<int> result;
+    int rarest = -1;
+    for(int i = 0; i < keys.count(); i++)
+    {
+        if(!m_postings.contains(keys[i]))
+        {
+            rarest = -1;
+            break;
+        }
+        if(rarest == -1 || m_postings[keys[i]].count() < m_postings[keys[rarest]].count())
+            rarest = i;
+    }
+    if(rarest != -1)
+        result = m_postings.value(keys[rarest]);
+
+    for(int i = 0; i < keys.count() && !result.isEmpty(); i++)
+    {
+        if(i == rarest)
+            continue;
+        const QVector<int> &postings = m_postings[keys[i]];
+        QVector<int> common;
+        int a = 0, b = 0;
+        while(a < result.count() && b < postings.count())
+        {
+            if(result[a] < postings[b]) a++;
+            else if(result[a] > postings[b]) b++;
+            else
+            {
+                common.append(result[a]);
+                a++; b++;
+            }
+        }
+        result = common;
+    }
+
+    foreach(int id, result)
+        paths.append(m_files.at(id).path);
+    foreach(int id, m_unindexed)
+        paths.append(m_files.at(id).path);
+    paths.sort();
+    return paths;
+}
+
+QList<SearchMatch> SearchIndex::match(const QString &filePath, const QString &text,
+                                      const QString &query, Qt::CaseSensitivity cs,
+                                      bool wholeWords)
+{
+    QList<SearchMatch> matches;
+    if(query.isEmpty())
+        return matches;
+
+    int line = 1;
+    int lineStart = 0;
+    int from = 0;
+    int pos;
+    while((pos = text.indexOf(query, from, cs)) != -1)
+    {
+        from = pos + query.size();
+        if(wholeWords && (isWordChar(text, pos - 1) || isWordChar(text, from)))
+            continue;
+
+        int newline;
+        while((newline = text.indexOf('\n', lineStart)) != -1 && newline < pos)
+        {
+            lineStart = newline + 1;
+            line++;
+        }
+        int lineEnd = text.indexOf('\n', pos);
+        if(lineEnd == -1)
+            lineEnd = text.size();
+
+        SearchMatch match;
+        match.filePath = filePath;
+        match.line = line;
+        match.column = pos - lineStart;
+        match.text = text.mid(lineStart, lineEnd - lineStart).trimmed();
+        matches.append(match);
+    }
+
+    return matches;
+}
+
+bool SearchIndex::isWordChar(const QString &text, int pos)
+{
+    if(pos < 0 || pos >= text.size())
+        return false;
+    QChar c = text.at(pos);
+    return c.isLetterOrNumber() || c == '_';
+}
+
+void SearchIndex::scan(const QString &dirPath, QStringList *paths)
+{
+    QStringList filters;
+    filters << "*.c" << "*.h" << "*.cpp" << "*.hpp" << "*.s" << "*.S" << "*.mk";
+
+    QDirIterator it(dirPath, filters, QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+        paths->append(it.next());
+}
+
+void SearchIndex::addFile(const QString &path, qint64 size, const QDateTime &modified)
+{
+    File file;
+    file.path = path;
+    file.size = size;
+    file.modified = modified;
+
+    QString text;
+    bool indexed = (size <= MaxFileSize && TextFile::read(path, &text));
+    if(indexed)
+        file.trigrams = trigrams(text);
+
+    int id;
+    if(!m_freeIds.isEmpty())
+    {
+        id = m_freeIds.takeFirst();
+        m_files[id] = file;
+    }
+    else
+    {
+        id = m_files.count();
+        m_files.append(file);
+    }
+    m_ids.insert(path, id);
+    if(!indexed)
+        m_unindexed.insert(id);
+
+    // postings stay sorted by file id
+    foreach(quint64 key, file.trigrams)
+    {
+        QVector<int> &postings = m_postings[key];
+        QVector<int>::iterator i = qLowerBound(postings.begin(), postings.end(), id);
+        postings.insert(i, id);
+    }
+}
+
+void SearchIndex::removeFile(int id)
+{
+    File &file = m_files[id];
+    foreach(quint64 key, file.trigrams)
+    {
+        QVector<int> &postings = m_postings[key];
+        QVector<int>::iterator i = qBinaryFind(postings.begin(), postings.end(), id);
+        if(i != postings.end())
+            postings.erase(i);
+        if(postings.isEmpty())
+            m_postings.remove(key);
+    }
+
+    m_ids.remove(file.path);
+    m_unindexed.remove(id);
+    file = File();
+    m_freeIds.append(id);
+}
+
+QVector<quint64> SearchIndex::trigrams(const QString &text)
+{
+    // case folded so one index serves both case modes
+    QSet<quint64> keys;
+    const QChar *data = text.constData();
+    int count = text.size();
+    for(int i = 0; i + 2 < count; i++)
+    {
+        quint64 key = ((quint64) data[i].toCaseFolded().unicode() << 32) |
+                      ((quint64) data[i+1].toCaseFolded().unicode() << 16) |
+                      (quint64) data[i+2].toCaseFolded().unicode();
+        keys.insert(key);
+    }
+
+    QVector<quint64> result;
+    result.reserve(keys.count());
+    foreach(quint64 key, keys)
+        result.append(key);
+    qSort(result);
+    return result;
+}
@@ -0,0 +1,94 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QDateTime>
+#include <QMetaType>
+
+class SearchMatch
+{
+public:
+    QString filePath;
+    int line;
+    int column;
+    QString text;
+};
+
+Q_DECLARE_METATYPE(SearchMatch)
+Q_DECLARE_METATYPE(QList<SearchMatch>)
+
+/*
+ * Trigram index over the source files found under a set of directories.
+ * update() only reads the files that changed since the last call and
+ * candidates() returns the files that contain every trigram of a query,
+ * which still have to be checked with match(). Not thread-safe, it is
+ * meant to be owned by a single worker.
+ */
+class SearchIndex
+{
+public:
+    SearchIndex();
+
+    void setRoots(const QStringList &roots);
+    int update();
+    QStringList candidates(const QString &query);
+    int fileCount() { return m_ids.count(); }
+
+    static QList<SearchMatch> match(const QString &filePath, const QString &text,
+                                    const QString &query, Qt::CaseSensitivity cs,
+                                    bool wholeWords = false);
+
+private:
+    enum
+    {
+        MaxFileSize = 4*1024*1024
+    };
+    class File
+    {
+    public:
+        QString path;
+        qint64 size;
+        QDateTime modified;
+        QVector<quint64> trigrams;
+    };
+
+    QStringList m_roots;
+    QHash<QString, int> m_ids;
+    QVector<File> m_files;
+    QList<int> m_freeIds;
+    // too big or unreadable, always returned by candidates()
+    QSet<int> m_unindexed;
+    QHash<quint64, QVector<int> > m_postings;
+
+    void scan(const QString &dirPath, QStringList *paths);
+    void addFile(const QString &path, qint64 size, const QDateTime &modified);
+    void removeFile(int id);
+
+    static QVector<quint64> trigrams(const QString &text);
+    static bool isWordChar(const QString &text, int pos);
+};
+
+#endif // SEARCHINDEX_H
@@ -0,0 +1,150 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serialcapture.h"
+
+#include <QDebug>
+#include <QtSerialPort/QSerialPort>
+
+SerialCapture::SerialCapture(RingBuffer<Sample> *buffer, QObject *parent) :
+    QObject(parent),
+    m_buffer(buffer),
+    m_port(0)
+{
+}
+
+SerialCapture::~SerialCapture()
+{
+    stop();
+}
+
+void SerialCapture::start(const QString &portName, int baudRate, const QString &logPath)
+{
+    stop();
+
+    // created here so the port belongs to the capture thread
+    m_port = new QSerialPort(this);
+    m_port->setPortName(portName);
+    if(!m_port->open(QIODevice::ReadOnly))
+    {
+        emit error(tr("Unable to open %1: %2").arg(portName).arg(m_port->errorString()));
+        delete m_port;
+        m_port = 0;
+        return;
+    }
+    m_port->setBaudRate(baudRate);
+    m_port->setParity(QSerialPort::NoParity);
+    m_port->setFlowControl(QSerialPort::NoFlowControl);
+    m_port->setDataBits(QSerialPort::Data8);
+    m_port->clear();
+
+    if(!m_log.open(logPath))
+    {
+        emit error(tr("Unable to create log %1: %2").arg(logPath).arg(m_log.errorString()));
+        m_port->close();
+        delete m_port;
+        m_port = 0;
+        return;
+    }
+
+    m_pending.clear();
+    m_sampleCount = 0;
+    m_droppedCount = 0;
+    m_clock.start();
+
+    connect(m_port, SIGNAL(readyRead()), this, SLOT(slotReadyRead()));
+    emit started(m_log.fileName());
+}
+
+void SerialCapture::stop()
+{
+    if(m_port == 0)
+        return;
+
+    // may be called from the port's own readyRead()
+    m_port->close();
+    m_port->deleteLater();
+    m_port = 0;
+    m_log.close();
+
+    emit stopped();
+}
+
+void SerialCapture::slotReadyRead()
+{
+    m_pending.append(m_port->readAll());
+
+    int start = 0;
+    int end;
+    while((end = m_pending.indexOf('\n', start)) != -1)
+    {
+        Sample sample;
+        if(parseFrame(m_pending.mid(start, end - start), &sample))
+        {
+            if(!m_log.append(sample.time, sample.values, sample.count))
+            {
+                // stop first so the error is what's left on screen
+                QString message = tr("Unable to write log %1: %2").arg(m_log.fileName()).arg(m_log.errorString());
+                stop();
+                emit error(message);
+                return;
+            }
+            m_sampleCount.ref();
+            // the log keeps everything, the plot may lose samples if the
+            // GUI falls behind
+            if(!m_buffer->push(sample))
+                m_droppedCount.ref();
+        }
+        start = end + 1;
+    }
+    m_pending.remove(0, start);
+
+    // garbage without line breaks, don't let it grow forever
+    if(m_pending.size() > 4096)
+        m_pending.clear();
+}
+
+bool SerialCapture::parseFrame(const QByteArray &frame, Sample *sample)
+{
+    sample->time = m_clock.nsecsElapsed()/1000;
+    sample->count = 0;
+
+    QByteArray field;
+    for(int i = 0; i <= frame.size(); i++)
+    {
+        char c = (i < frame.size() ? frame.at(i) : ',');
+        if(c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\r')
+        {
+            if(field.isEmpty())
+                continue;
+            if(sample->count == MaxChannels)
+                break;
+            bool ok;
+            float value = field.toFloat(&ok);
+            if(!ok)
+                return false;
+            sample->values[sample->count++] = value;
+            field.clear();
+        }
+        else
+            field.append(c);
+    }
+
+    return sample->count > 0;
+}
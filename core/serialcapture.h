@@ -0,0 +1,83 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERIALCAPTURE_H
+#define SERIALCAPTURE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include "ringbuffer.h"
+#include "binarylog.h"
+
+class QSerialPort;
+
+/*
+ * Reads newline terminated frames of numeric values (separated by
+ * commas, semicolons or whitespace) from a serial port. Meant to live in
+ * its own thread: every frame is appended to a binary log and pushed to
+ * a ring buffer that the GUI drains at its own pace.
+ */
+class SerialCapture : public QObject
+{
+    Q_OBJECT
+public:
+    enum
+    {
+        MaxChannels = 8
+    };
+
+    class Sample
+    {
+    public:
+        qint64 time;
+        int count;
+        float values[MaxChannels];
+    };
+
+    explicit SerialCapture(RingBuffer<Sample> *buffer, QObject *parent = 0);
+    ~SerialCapture();
+
+    int sampleCount() { return m_sampleCount.load(); }
+    int droppedCount() { return m_droppedCount.load(); }
+
+signals:
+    void started(QString logFileName);
+    void stopped();
+    void error(QString message);
+
+public slots:
+    void start(const QString &portName, int baudRate, const QString &logPath);
+    void stop();
+
+private slots:
+    void slotReadyRead();
+
+private:
+    RingBuffer<Sample> *m_buffer;
+    QSerialPort *m_port;
+    BinaryLog m_log;
+    QByteArray m_pending;
+    QElapsedTimer m_clock;
+    QAtomicInt m_sampleCount;
+    QAtomicInt m_droppedCount;
+
+    bool parseFrame(const QByteArray &frame, Sample *sample);
+};
+
+#endif // SERIALCAPTURE_H
@@ -0,0 +1,131 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serialportmonitor.h"
+#include "applog.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QtSerialPort/QSerialPortInfo>
+
+SerialPortMonitor::SerialPortMonitor(QObject *parent) :
+    QObject(parent),
+    m_timer(0),
+    m_watcher(0),
+    m_interval(DefaultInterval)
+{
+}
+
+void SerialPortMonitor::start()
+{
+    // created here so they live in the monitor's thread
+    if(m_timer == 0)
+    {
+        m_timer = new QTimer(this);
+        connect(m_timer, SIGNAL(timeout()), this, SLOT(slotPoll()));
+    }
+
+#ifdef Q_OS_LINUX
+    // device nodes are created/removed by udev on hotplug, so watching /dev
+    // gives immediate notification; the timer is just a fallback
+    if(m_watcher == 0)
+    {
+        m_watcher = new QFileSystemWatcher(this);
+        m_watcher->addPath("/dev");
+        connect(m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(slotPoll()));
+    }
+#endif
+
+    m_timer->start(m_interval);
+    refresh();
+}
+
+void SerialPortMonitor::stop()
+{
+    if(m_timer != 0)
+        m_timer->stop();
+}
+
+void SerialPortMonitor::refresh()
+{
+    m_devNodes = devNodes();
+    update(availablePorts());
+}
+
+void SerialPortMonitor::slotPoll()
+{
+#ifdef Q_OS_LINUX
+    // listing /dev is much cheaper than a full enumeration, only
+    // enumerate again when the tty nodes actually changed
+    QStringList nodes = devNodes();
+    if(nodes == m_devNodes)
+        return;
+    m_devNodes = nodes;
+#endif
+    update(availablePorts());
+}
+
+QStringList SerialPortMonitor::devNodes()
+{
+    QStringList nodes;
+#ifdef Q_OS_LINUX
+    QStringList filters;
+    filters << "ttyACM*" << "ttyUSB*";
+    nodes = QDir("/dev").entryList(filters, QDir::System, QDir::Name);
+#endif
+    return nodes;
+}
+
+QStringList SerialPortMonitor::availablePorts()
+{
+    QStringList list;
+    foreach(QSerialPortInfo info, QSerialPortInfo::availablePorts())
+    {
+        QString portName = info.portName();
+        if(portName.contains("ACM") || portName.contains("USB"))
+            list.append(portName);
+    }
+    list.sort();
+    return list;
+}
+
+void SerialPortMonitor::update(const QStringList &ports)
+{
+    foreach(QString portName, m_ports)
+    {
+        if(!ports.contains(portName))
+        {
+            qkLog(Serial) << "serial port removed:" << portName;
+            emit portRemoved(portName);
+        }
+    }
+
+    foreach(QString portName, ports)
+    {
+        if(!m_ports.contains(portName))
+        {
+            qkLog(Serial) << "serial port added:" << portName;
+            emit portAdded(portName);
+        }
+    }
+
+    m_ports = ports;
+}
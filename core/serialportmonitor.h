@@ -0,0 +1,71 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERIALPORTMONITOR_H
+#define SERIALPORTMONITOR_H
+
+#include <QObject>
+#include <QStringList>
+
+class QTimer;
+class QFileSystemWatcher;
+
+/*
+ * Watches the available serial ports from a worker thread and reports
+ * ports as they come and go. Create it without parent, move it to a
+ * QThread and connect the thread's started() signal to start().
+ */
+class SerialPortMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SerialPortMonitor(QObject *parent = 0);
+
+    void setInterval(int msec) { m_interval = msec; }
+
+signals:
+    void portAdded(QString portName);
+    void portRemoved(QString portName);
+
+public slots:
+    void start();
+    void stop();
+    void refresh();
+
+private slots:
+    void slotPoll();
+
+private:
+    enum
+    {
+        DefaultInterval = 1000
+    };
+
+    QTimer *m_timer;
+    QFileSystemWatcher *m_watcher;
+    int m_interval;
+    QStringList m_ports;
+    QStringList m_devNodes;
+
+    QStringList devNodes();
+    QStringList availablePorts();
+    void update(const QStringList &ports);
+};
+
+#endif // SERIALPORTMONITOR_H
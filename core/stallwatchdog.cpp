@@ -0,0 +1,145 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stallwatchdog.h"
+
+#include <QDebug>
+#include <QTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+QAtomicPointer<const char> StallWatchdog::m_phase;
+
+StallWatchdog::StallWatchdog(int threshold, QObject *parent) :
+    QThread(parent),
+    m_pending(64)
+{
+    m_threshold = qMax((int)MinThreshold, threshold);
+    m_interval = m_threshold / 4;
+    m_sessionStart = QDateTime::currentDateTime();
+    m_clock.start();
+
+    // not armed until the event loop delivers the first beat
+    m_lastBeat.store(-1);
+    m_quit.store(0);
+
+    m_heartbeatTimer = new QTimer(this);
+    m_heartbeatTimer->setInterval(m_interval);
+    connect(m_heartbeatTimer, SIGNAL(timeout()), this, SLOT(slotHeartbeat()));
+    m_heartbeatTimer->start();
+
+    connect(this, SIGNAL(stallDetected()), this, SLOT(slotDrain()));
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    m_quit.store(1);
+    wait();
+}
+
+void StallWatchdog::slotHeartbeat()
+{
+    m_lastBeat.store((int)m_clock.elapsed());
+}
+
+void StallWatchdog::run()
+{
+    bool stalling = false;
+    int start = 0;
+    QStringList phases;
+
+    while(m_quit.load() == 0)
+    {
+        msleep(m_interval);
+
+        int lastBeat = m_lastBeat.load();
+        if(lastBeat < 0)
+            continue;
+        int now = (int)m_clock.elapsed();
+
+        if(now - lastBeat > m_threshold)
+        {
+            if(!stalling)
+            {
+                stalling = true;
+                start = lastBeat;
+                phases.clear();
+            }
+            const char *phase = m_phase.load();
+            if(phase != 0 && !phases.contains(phase) && phases.count() < MaxPhases)
+                phases.append(phase);
+        }
+        else if(stalling)
+        {
+            stalling = false;
+
+            // the gap between two beats, less the beat period itself
+            Stall stall;
+            stall.duration = lastBeat - start - m_interval;
+            stall.time = QDateTime::currentDateTime().addMSecs(start - now);
+            stall.phases = phases.isEmpty() ? QString("unknown") : phases.join(" > ");
+            if(m_pending.push(stall))
+                emit stallDetected();
+        }
+    }
+}
+
+void StallWatchdog::slotDrain()
+{
+    Stall stall;
+    while(m_pending.pop(&stall))
+    {
+        m_stalls.append(stall);
+        if(m_stalls.count() > MaxStalls)
+            m_stalls.removeFirst();
+        emit stalled(stall.duration, stall.phases);
+    }
+}
+
+QList<StallWatchdog::Stall> StallWatchdog::stalls()
+{
+    slotDrain();
+    return m_stalls;
+}
+
+bool StallWatchdog::writeLog(const QString &filePath)
+{
+    QList<Stall> list = stalls();
+    if(list.isEmpty())
+        return true;
+
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+    {
+        qDebug() << "unable to write stall log:" << filePath << file.errorString();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "session " << m_sessionStart.toString(Qt::ISODate)
+        << ", threshold " << m_threshold << " ms, "
+        << list.count() << " stalls\n";
+    foreach(const Stall &stall, list)
+    {
+        out << stall.time.toString("yyyy-MM-dd hh:mm:ss.zzz") << '\t'
+            << stall.duration << " ms\t" << stall.phases << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QList>
+#include "ringbuffer.h"
+
+class QTimer;
+
+/*
+ * Detects GUI event loop stalls. A timer in the GUI thread beats every
+ * threshold/4 ms and the watchdog thread reports every gap longer than the
+ * threshold, along with the phases that were active while it lasted. Code
+ * that may block the GUI thread marks itself with a Phase.
+ */
+class StallWatchdog : public QThread
+{
+    Q_OBJECT
+public:
+    class Phase
+    {
+    public:
+        explicit Phase(const char *name) :
+            m_previous(StallWatchdog::m_phase.fetchAndStoreOrdered(name)) {}
+        ~Phase() { StallWatchdog::m_phase.fetchAndStoreOrdered(m_previous); }
+    private:
+        const char *m_previous;
+    };
+
+    class Stall
+    {
+    public:
+        QDateTime time;
+        int duration;
+        QString phases;
+    };
+
+    explicit StallWatchdog(int threshold, QObject *parent = 0);
+    ~StallWatchdog();
+
+    int threshold() { return m_threshold; }
+    QList<Stall> stalls();
+    bool writeLog(const QString &filePath);
+
+signals:
+    void stalled(int duration, QString phases);
+    void stallDetected();
+
+protected:
+    void run();
+
+private slots:
+    void slotHeartbeat();
+    void slotDrain();
+
+private:
+    enum
+    {
+        MinThreshold = 40,
+        MaxStalls = 100,
+        MaxPhases = 4
+    };
+
+    int m_threshold;
+    int m_interval;
+    QElapsedTimer m_clock;
+    QDateTime m_sessionStart;
+    QAtomicInt m_lastBeat;
+    QAtomicInt m_quit;
+    QTimer *m_heartbeatTimer;
+    RingBuffer<Stall> m_pending;
+    QList<Stall> m_stalls;
+
+    static QAtomicPointer<const char> m_phase;
+};
+
+#endif // STALLWATCHDOG_H
@@ -0,0 +1,137 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startupprofiler.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QCoreApplication>
+
+QElapsedTimer StartupProfiler::m_timer;
+QList<StartupProfiler::Phase> StartupProfiler::m_phases;
+QList<int> StartupProfiler::m_open;
+bool StartupProfiler::m_running = false;
+
+void StartupProfiler::start()
+{
+    m_timer.start();
+    m_phases.clear();
+    m_open.clear();
+    m_running = true;
+}
+
+void StartupProfiler::begin(const char *phase)
+{
+    if(!m_running)
+        return;
+
+    Phase p;
+    p.name = phase;
+    p.start = m_timer.nsecsElapsed();
+    p.duration = -1;
+    p.depth = m_open.count();
+    m_open.append(m_phases.count());
+    m_phases.append(p);
+}
+
+void StartupProfiler::end()
+{
+    if(!m_running || m_open.isEmpty())
+        return;
+
+    Phase &p = m_phases[m_open.takeLast()];
+    p.duration = m_timer.nsecsElapsed() - p.start;
+}
+
+QString StartupProfiler::finish(const QString &dirPath, bool writeTrace)
+{
+    if(!m_running)
+        return QString();
+
+    while(!m_open.isEmpty())
+        end();
+    m_running = false;
+    qint64 total = m_timer.nsecsElapsed();
+
+    QString date = QDateTime::currentDateTime().toString(Qt::ISODate);
+    QString version = QCoreApplication::applicationVersion();
+
+    QString report;
+    QTextStream text(&report);
+    text << "startup " << date << " " << version << "\n";
+    foreach(const Phase &p, m_phases)
+    {
+        text << QString(2 + p.depth*2, ' ') << p.name
+             << QString(qMax(1, 32 - p.depth*2 - (int) qstrlen(p.name)), ' ')
+             << QString::number(p.duration / 1e6, 'f', 1) << " ms\n";
+    }
+    text << "  total" << QString(27, ' ') << QString::number(total / 1e6, 'f', 1) << " ms\n";
+    text.flush();
+
+    QDir().mkpath(dirPath);
+
+    QFile reportFile(dirPath + "/startup_profile.txt");
+    if(reportFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        reportFile.write(report.toUtf8());
+    else
+        qDebug() << "can't write startup report" << reportFile.errorString();
+
+    // one row per phase and launch, to follow regressions across releases
+    QFile historyFile(dirPath + "/startup_history.csv");
+    bool newHistory = !historyFile.exists();
+    if(historyFile.open(QIODevice::Append | QIODevice::Text))
+    {
+        QTextStream out(&historyFile);
+        if(newHistory)
+            out << "date,version,phase,ms\n";
+        foreach(const Phase &p, m_phases)
+        {
+            if(p.depth == 0)
+                out << date << "," << version << "," << p.name << ","
+                    << QString::number(p.duration / 1e6, 'f', 1) << "\n";
+        }
+        out << date << "," << version << ",total," << QString::number(total / 1e6, 'f', 1) << "\n";
+    }
+
+    if(writeTrace)
+    {
+        // chrome://tracing format, times in microseconds
+        QFile traceFile(dirPath + "/startup_trace.json");
+        if(traceFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            QTextStream out(&traceFile);
+            out << "{\"traceEvents\":[\n";
+            for(int i = 0; i < m_phases.count(); i++)
+            {
+                const Phase &p = m_phases.at(i);
+                out << "{\"name\":\"" << p.name << "\",\"cat\":\"startup\",\"ph\":\"X\","
+                    << "\"ts\":" << p.start / 1000 << ",\"dur\":" << p.duration / 1000
+                    << ",\"pid\":1,\"tid\":1}" << (i + 1 < m_phases.count() ? ",\n" : "\n");
+            }
+            out << "]}\n";
+        }
+        else
+            qDebug() << "can't write startup trace" << traceFile.errorString();
+    }
+
+    return report;
+}
@@ -0,0 +1,63 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QString>
+#include <QList>
+#include <QElapsedTimer>
+
+/*
+ * Times the phases of the application startup. Phases may nest and are
+ * recorded until finish() writes the report, after which begin() and end()
+ * do nothing. Only meant to be used from the GUI thread.
+ */
+class StartupProfiler
+{
+public:
+    class Scope
+    {
+    public:
+        explicit Scope(const char *phase) { StartupProfiler::begin(phase); }
+        ~Scope() { StartupProfiler::end(); }
+    };
+
+    static void start();
+    static void begin(const char *phase);
+    static void end();
+    static QString finish(const QString &dirPath, bool writeTrace);
+
+private:
+    class Phase
+    {
+    public:
+        const char *name;
+        qint64 start;
+        qint64 duration;
+        int depth;
+    };
+
+    static QElapsedTimer m_timer;
+    static QList<Phase> m_phases;
+    static QList<int> m_open;
+    static bool m_running;
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,89 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "textfile.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextCodec>
+
+bool TextFile::read(const QString &filePath, QString *text, QTextCodec **codec)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "can't open file:" << filePath << file.errorString();
+        return false;
+    }
+
+    qint64 size = file.size();
+    if(size == 0)
+    {
+        text->clear();
+        if(codec != 0)
+            *codec = QTextCodec::codecForName("UTF-8");
+        return true;
+    }
+
+    // decode straight from the mapped pages, no intermediate copy
+    uchar *data = file.map(0, size);
+    if(data != 0)
+    {
+        *text = decode(QByteArray::fromRawData((const char*)data, size), codec);
+        file.unmap(data);
+    }
+    else
+        *text = decode(file.readAll(), codec);
+
+    file.close();
+    return true;
+}
+
+QString TextFile::decode(const QByteArray &data, QTextCodec **codec)
+{
+    // BOM first, then strict UTF-8, then Latin-1 which never fails
+    QTextCodec *c = QTextCodec::codecForUtfText(data, 0);
+    QString text;
+
+    if(c == 0)
+    {
+        QTextCodec *utf8 = QTextCodec::codecForName("UTF-8");
+        QTextCodec::ConverterState state;
+        text = utf8->toUnicode(data.constData(), data.size(), &state);
+        if(state.invalidChars == 0 && state.remainingChars == 0)
+            c = utf8;
+        else
+        {
+            c = QTextCodec::codecForName("ISO-8859-1");
+            text = c->toUnicode(data);
+        }
+    }
+    else
+        text = c->toUnicode(data);
+
+    if(text.contains('\r'))
+    {
+        text.replace("\r\n", "\n");
+        text.replace('\r', '\n');
+    }
+
+    if(codec != 0)
+        *codec = c;
+    return text;
+}
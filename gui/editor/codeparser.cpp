@@ -19,6 +19,8 @@
 
 #include "codeparser.h"
 #include "qkide_global.h"
+#include "perfcounters.h"
+#include "applog.h"
 
 #include <QProcess>
 #include <QDebug>
@@ -47,13 +49,14 @@ void CodeParser::parse(const QString &path)
 
 void CodeParser::parse()
 {
+    PerfCounters::Scope scope(PerfCounters::ParseCycle);
     QString path = m_path;
     QString program = qApp->applicationDirPath() + CTAGS_EXE;
     QStringList arguments;
     //QString output = "-f " + TAGS_DIR + "/tags";
     QString tagsDir = TAGS_DIR;
     QString output = qApp->applicationDirPath() + TAGS_DIR + "/tags";
-    arguments << "-f" << output << "--languages=-Make" << "--c-kinds=+p-m" << "-R" << path;
+    arguments << "-f" << output << "--languages=-Make" << "--c-kinds=+p-m" << "--fields=+n" << "-R" << path;
     //arguments << "--languages=-Make" << "-R" << path;
     //arguments << "-R" << path;
 
@@ -61,7 +64,7 @@ void CodeParser::parse()
     process.setProcessChannelMode(QProcess::MergedChannels);
     //process.setWorkingDirectory(path);    
 
-    qDebug() << __FUNCTION__ << program << arguments;
+    qkLog(Parser) << __FUNCTION__ << program << arguments;
 
 
     process.start(program, arguments);
@@ -71,13 +74,23 @@ void CodeParser::parse()
         return;
     }
 
-    qDebug() << process.readAll();
+    qkLog(Parser) << process.readAll();
 
-    QFile tags(QApplication::applicationDirPath() + TAGS_DIR + "/tags");
+    if(!loadTags(output))
+        return;
+
+    emit parsed();
+}
+
+bool CodeParser::loadTags(const QString &filePath)
+{
+    static const QRegularExpression re("(\\/\\^.*\\$\\/;\")|([^\\t]+)");
+
+    QFile tags(filePath);
     if(!tags.open(QIODevice::ReadOnly | QIODevice::Text))
     {
         qDebug() << "failed to open tags file:" << tags.fileName();
-        return;
+        return false;
     }
 
     clear();
@@ -87,7 +100,6 @@ void CodeParser::parse()
         if(line[0] == '!' || line[0] == '_')
             continue;
 
-        QRegularExpression re("(\\/\\^.*\\$\\/;\")|([^\\t]+)");
         QRegularExpressionMatchIterator it = re.globalMatch(line);
         QStringList fields;
         while (it.hasNext())
@@ -102,10 +114,17 @@ void CodeParser::parse()
         el.fileName = fields.at(1);
         el.expression = fields[2].remove('"');
         el.local = false;
+        el.declaration = false;
+        el.line = 0;
         el.type = Element::Unknown;
 
         QString typeStr = fields.at(3);
         typeStr.remove('\n');
+        for(int i = 4; i < fields.count(); i++)
+        {
+            if(fields[i].startsWith("line:"))
+                el.line = fields[i].mid(5).trimmed().toInt();
+        }
         if(typeStr == "f" || typeStr == "p")
         {
             el.type = Element::Function;
@@ -114,6 +133,7 @@ void CodeParser::parse()
             el.prototype.remove('^');
             el.prototype.remove('/');
             el.prototype.remove(';');
+            el.declaration = (typeStr == "p");
         }
         else if(typeStr == "d")
             el.type = Element::Define;
@@ -124,6 +144,9 @@ void CodeParser::parse()
         else if(typeStr == "e")
             el.type = Element::Enum;
 
+        if(el.type != Element::Unknown)
+            m_tags.append(el);
+
         switch(el.type)
         {
         case Element::Function:
@@ -163,7 +186,7 @@ void CodeParser::parse()
 //    foreach(const Element &el, m_variables)
 //        qDebug() << el.text;
 
-    emit parsed();
+    return true;
 }
 
 QList<CodeParser::Element> CodeParser::allElements()
@@ -180,6 +203,7 @@ QList<CodeParser::Element> CodeParser::allElements()
 
 void CodeParser::clear()
 {
+    m_tags.clear();
     m_defines.clear();
     m_enums.clear();
     m_types.clear();
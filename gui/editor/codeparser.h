@@ -49,6 +49,8 @@ public:
         QString prototype;
         Type type;
         bool local;
+        bool declaration;
+        int line;
     };
 
     explicit CodeParser(QObject *parent = 0);
@@ -59,8 +61,10 @@ public:
     QList<Element> enums() { return m_enums; }
     QList<Element> types() { return m_types; }
     QList<Element> variables() { return m_variables; }
+    QList<Element> tags() { return m_tags; }
 
     static int hasElement(const QString &text, const QList<Element> &list);
+    bool loadTags(const QString &filePath);
 
 signals:
     void parsed();
@@ -81,6 +85,7 @@ private:
     QList<Element> m_enums;
     QList<Element> m_types;
     QList<Element> m_variables;
+    QList<Element> m_tags;
     QString m_path;
 
 
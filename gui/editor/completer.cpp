@@ -19,6 +19,7 @@
 
 #include "completer.h"
 #include "qkide_global.h"
+#include "perfcounters.h"
 
 #include <QAbstractItemView>
 #include <QDebug>
@@ -117,12 +118,68 @@ void Completer::updateModel()
 {
     m_model->clear();
     m_model->setColumnCount(1);
+    m_signatures.clear();
 
     foreach(CodeParser::Element el, m_extraElements)
         createItem(el);
 
     foreach(CodeParser::Element el, m_permanentElements)
         createItem(el);
+
+    // library prototypes win over project ones, as in functions()
+    foreach(const CodeParser::Element &el, m_permanentElements)
+        addSignature(el);
+    foreach(const CodeParser::Element &el, m_extraElements)
+        addSignature(el);
+
+    PerfCounters::setGauge(PerfCounters::SymbolsLoaded, m_model->rowCount());
+}
+
+const Completer::Signature* Completer::signature(const QString &functionName) const
+{
+    QHash<QString, Signature>::const_iterator it = m_signatures.constFind(functionName);
+    if(it == m_signatures.constEnd())
+        return 0;
+    return &it.value();
+}
+
+void Completer::addSignature(const CodeParser::Element &element)
+{
+    if(element.type != CodeParser::Element::Function || m_signatures.contains(element.text))
+        return;
+
+    Signature signature;
+    signature.prototype = element.prototype.trimmed();
+
+    int open = signature.prototype.indexOf('(');
+    if(open == -1)
+        return;
+
+    // split the parameter list once, on the commas outside nested parentheses
+    int depth = 0;
+    int start = open + 1;
+    for(int i = open + 1; i < signature.prototype.size(); i++)
+    {
+        QChar c = signature.prototype.at(i);
+        if(c == '(')
+            depth++;
+        else if(c == ')' && depth > 0)
+            depth--;
+        else if((c == ',' && depth == 0) || c == ')')
+        {
+            while(start < i && signature.prototype.at(start).isSpace())
+                start++;
+            int end = i;
+            while(end > start && signature.prototype.at(end - 1).isSpace())
+                end--;
+            signature.parameters.append(qMakePair(start, end - start));
+            start = i + 1;
+            if(c == ')')
+                break;
+        }
+    }
+
+    m_signatures.insert(element.text, signature);
 }
 
 
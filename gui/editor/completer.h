@@ -21,6 +21,8 @@
 #define COMPLETER_H
 
 #include <QCompleter>
+#include <QHash>
+#include <QPair>
 #include "codeparser.h"
 
 class QStandardItemModel;
@@ -29,8 +31,17 @@ class Completer : public QCompleter
 {
     Q_OBJECT
 public:
+    class Signature
+    {
+    public:
+        QString prototype;
+        QList< QPair<int,int> > parameters;
+    };
+
     explicit Completer(QObject *parent = 0);
 
+    const Signature* signature(const QString &functionName) const;
+
 public slots:
     void addElements(QList<CodeParser::Element> elements, bool permanent = false);
     void clearElements(bool permanent = false);
@@ -47,10 +58,12 @@ private:
     void addElement(const CodeParser::Element &element, bool permanent = false);
     void updateModel();
     void createItem(CodeParser::Element &element);
+    void addSignature(const CodeParser::Element &element);
 
     QList<CodeParser::Element> m_extraElements;
     QList<CodeParser::Element> m_permanentElements;
     QStandardItemModel *m_model;
+    QHash<QString, Signature> m_signatures;
 };
 
 #endif // COMPLETER_H
@@ -21,10 +21,16 @@
 #include <QVBoxLayout>
 #include <QSplitter>
 #include <QFile>
+#include <QThread>
+#include <QCoreApplication>
 #include "editor.h"
 #include "pagetab.h"
 #include "page.h"
 #include "findreplacedialog.h"
+#include "textfile.h"
+#include "filesaver.h"
+#include "stallwatchdog.h"
+#include "applog.h"
 
 #include <QDebug>
 
@@ -33,6 +39,7 @@ Editor::Editor(QWidget *parent) :
     QWidget(parent)
 {
     m_activePage = 0;
+    m_blockPageLoad = false;
 
     mainTabs = new PageTab();
     mainTabs->setMovable(true);
@@ -63,13 +70,26 @@ Editor::Editor(QWidget *parent) :
     verticalSplitter->hide();
 
     connect(mainTabs, SIGNAL(tabCloseRequested(int)), this, SLOT(tabCloseRequestHandler(int)));
+    connect(mainTabs, SIGNAL(currentChanged(int)), this, SLOT(currentTabChanged(int)));
     connect(splittedTabs, SIGNAL(tabCloseRequested(int)), this, SLOT(tabCloseRequestHandler(int)));
 
     m_findReplaceDialog = new FindReplaceDialog(this);
+
+    m_fileSaverThread = new QThread(this);
+    m_fileSaver = new FileSaver;
+    m_fileSaver->moveToThread(m_fileSaverThread);
+    connect(m_fileSaverThread, SIGNAL(finished()), m_fileSaver, SLOT(deleteLater()));
+    connect(m_fileSaver, SIGNAL(saved(QString,int)), this, SLOT(pageSaved(QString,int)));
+    connect(m_fileSaver, SIGNAL(error(QString,QString)), this, SLOT(pageSaveError(QString,QString)));
+    m_fileSaverThread->start();
 }
 
 Editor::~Editor()
 {
+    m_fileSaver->waitForIdle();
+    m_fileSaverThread->quit();
+    m_fileSaverThread->wait();
+
     delete m_findReplaceDialog;
     delete verticalSplitter;
     delete horizontalSplitter;
@@ -81,7 +101,7 @@ Editor::~Editor()
 void Editor::updateActivePage()
 {
     Page *senderPage = qobject_cast<Page *>(sender());
-    qDebug() << "updateActivePage() sender =" << senderPage->name();
+    qkLog(Editor) << "updateActivePage() sender =" << senderPage->name();
     m_activePage = senderPage;
     m_findReplaceDialog->setPage(m_activePage);
 }
@@ -124,6 +144,69 @@ Page* Editor::addPage(const QString &pageName)
     return addPage(pageName, pageName);
 }
 
+void Editor::addLazyPage(const QString &pageName, const QString &filePath,
+                         const QString &tabName)
+{
+    // cheap placeholder, the real page is only built when the tab is shown
+    QWidget *placeholder = new QWidget(mainTabs);
+    placeholder->setProperty("pageName", pageName);
+    placeholder->setProperty("filePath", filePath);
+    mainTabs->addTab(placeholder, tabName.isEmpty() ? pageName : tabName);
+}
+
+Page* Editor::loadPage(int index)
+{
+    if(index < 0 || index >= mainTabs->count())
+        return 0;
+
+    Page *page = this->page(index);
+    if(page != 0)
+        return page;
+
+    QWidget *placeholder = mainTabs->widget(index);
+    QString pageName = placeholder->property("pageName").toString();
+    QString filePath = placeholder->property("filePath").toString();
+    QString tabName = mainTabs->tabText(index);
+
+    StallWatchdog::Phase phase("Editor::loadPage");
+
+    QString text;
+    if(!TextFile::read(filePath, &text))
+        return 0;
+
+    bool current = (mainTabs->currentIndex() == index);
+
+    m_blockPageLoad = true;
+    page = new Page(pageName, mainTabs);
+    mainTabs->removeTab(index);
+    mainTabs->insertTab(index, page, tabName);
+    if(current)
+        mainTabs->setCurrentIndex(index);
+    m_blockPageLoad = false;
+    delete placeholder;
+
+    connect(page, SIGNAL(textChanged()), this, SLOT(updatePageText()));
+    connect(page, SIGNAL(focused()), this, SLOT(updateActivePage()));
+    emit pageCreated(page);
+    page->loadText(text);
+
+    if(m_splitted)
+    {
+        Page *splittedPage = new Page(pageName, splittedTabs);
+        splittedPage->setPlainText(text);
+        splittedTabs->addTab(splittedPage, tabName);
+        connect(splittedPage, SIGNAL(textChanged()), this, SLOT(updatePageText()));
+    }
+
+    return page;
+}
+
+void Editor::currentTabChanged(int index)
+{
+    if(!m_blockPageLoad && index != -1 && !isPageLoaded(index))
+        loadPage(index);
+}
+
 void Editor::removePage(const QString &pageName)
 {
     int tabIndex;
@@ -154,21 +237,20 @@ void Editor::closeAllPages()
     for(int i=0; i < mainTabs->count(); i++)
     {
         page = qobject_cast<Page *>(mainTabs->widget(i));
-        page->close();
+        if(page != 0)
+            page->close();
+        else
+            mainTabs->widget(i)->deleteLater();
     }
 
+    m_blockPageLoad = true;
     mainTabs->clear();
+    m_blockPageLoad = false;
 }
 
 int Editor::hasPage(const QString &pageName)
 {
-    for(int i=0; i < mainTabs->count(); i++)
-    {
-        if(page(i)->name().compare(pageName) == 0)
-            return i;
-    }
-
-    return -1;
+    return mainTabs->hasPage(pageName);
 }
 
 bool Editor::hasModifiedPages()
@@ -193,12 +275,7 @@ int Editor::countPages()
 
 QList<Page *> Editor::pages()
 {
-    QList<Page *> list;
-    int i, count = countPages();
-    for(i=0; i<count; i++) {
-        list.append(page(i));
-    }
-    return list;
+    return mainTabs->pages();
 }
 
 Page* Editor::page(int index)
@@ -211,22 +288,63 @@ Page* Editor::currentPage()
     return qobject_cast<Page *>(mainTabs->currentWidget());
 }
 
+QString Editor::pageName(int index)
+{
+    return mainTabs->pageName(index);
+}
+
+bool Editor::isPageLoaded(int index)
+{
+    return page(index) != 0;
+}
+
+QString Editor::pageFilePath(int index)
+{
+    return mainTabs->widget(index)->property("filePath").toString();
+}
+
 
 void Editor::savePage(int index, const QString &filePath)
 {
-    QFile file(filePath);
-    if(!file.open(QIODevice::WriteOnly))
-    {
-        qDebug() << "Can't open" << filePath;
+    if(!isPageLoaded(index))
+        return;
+
+    qkLog(Editor) << "save page/file path" << filePath;
+
+    // the text is implicitly shared, the worker encodes and writes it
+    Page *page = this->page(index);
+    m_savingPages.insert(filePath, page->name());
+    m_fileSaver->save(filePath, page->text(), page->document()->revision());
+}
+
+bool Editor::waitForSaves()
+{
+    bool idle = m_fileSaver->waitForIdle();
+    // deliver the queued saved() notifications so pages are up to date
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    return idle;
+}
+
+void Editor::pageSaved(const QString &filePath, int revision)
+{
+    int index = hasPage(m_savingPages.value(filePath));
+    if(index == -1 || !isPageLoaded(index))
         return;
+
+    // edits made while the file was being written keep the page modified
+    Page *page = this->page(index);
+    if(page->document()->revision() == revision)
+    {
+        page->document()->setModified(false);
+        emit pageWritten(page);
     }
-    qDebug() << "save page/file path" << filePath;
-    file.write(page(index)->text().toLatin1());
-    file.close();
 
-    page(index)->document()->setModified(false);
+    qkLog(Editor) << page->name() << "saved";
+}
 
-    qDebug() << page(index)->name() << "saved";
+void Editor::pageSaveError(const QString &filePath, const QString &message)
+{
+    qDebug() << "Can't save" << filePath << message;
 }
 
 void Editor::savePage(const QString &pageName, const QString &filePath)
@@ -300,6 +418,8 @@ void Editor::createSplittedTabs()
     for(int i = 0; i < mainTabs->count(); i++)
     {
         page = qobject_cast<Page *>(mainTabs->widget(i));
+        if(page == 0)
+            continue;
         splittedPage = new Page(page->name(), this);
         splittedPage->setPlainText(page->text());
         splittedTabs->addTab(splittedPage, splittedPage->name());
@@ -361,7 +481,7 @@ void Editor::updatePageText()
 void Editor::tabCloseRequestHandler(int index)
 {
     PageTab *senderPageTab = qobject_cast<PageTab *>(sender());
-    emit tabCloseRequested(senderPageTab->page(index)->name());
+    emit tabCloseRequested(senderPageTab->pageName(index));
 }
 
 void Editor::showSearch()
@@ -30,6 +30,8 @@ class QTabWidget;
 class QLayout;
 class PageTab;
 class FindReplaceDialog;
+class FileSaver;
+class QThread;
 
 
 
@@ -48,14 +50,23 @@ public:
     QList<Page*> pages();
     Page* page(int index);
     Page* currentPage();
+    QString pageName(int index);
+    bool isPageLoaded(int index);
+    QString pageFilePath(int index);
+    bool waitForSaves();
 
 signals:
     void tabCloseRequested(QString);
+    void pageCreated(Page*);
+    void pageWritten(Page*);
 
 public slots:
     void addTab(const QString &tabName, QWidget *widget);
     Page* addPage(const QString &tabName, const QString &pageName);
     Page* addPage(const QString &pageName);
+    void addLazyPage(const QString &pageName, const QString &filePath,
+                     const QString &tabName = QString());
+    Page* loadPage(int index);
     void removePage(const QString &pageName);
     void savePage(int index, const QString &filePath);
     void savePage(const QString &pageName, const QString &filePath);
@@ -68,6 +79,9 @@ private slots:
     void updateActivePage();
     void updatePageText();
     void tabCloseRequestHandler(int index);
+    void currentTabChanged(int index);
+    void pageSaved(const QString &filePath, int revision);
+    void pageSaveError(const QString &filePath, const QString &message);
 
 private:
     PageTab *mainTabs;
@@ -81,6 +95,7 @@ private:
     Page *m_activePage;
 
     bool m_splitted;
+    bool m_blockPageLoad;
 
     void split(QSplitter *splitter);
     void createSplittedTabs();
@@ -92,6 +107,9 @@ signals:
 
 private:
     FindReplaceDialog *m_findReplaceDialog;
+    FileSaver *m_fileSaver;
+    QThread *m_fileSaverThread;
+    QHash<QString, QString> m_savingPages;
 
 };
 
@@ -23,6 +23,9 @@
 #include <QTextDocument>
 #include <QPlainTextEdit>
 #include "page.h"
+#include "matchcounter.h"
+#include <QThread>
+#include <QTimer>
 
 FindReplaceDialog::FindReplaceDialog(QWidget *parent) :
     QDialog(parent),
@@ -36,12 +39,33 @@ FindReplaceDialog::FindReplaceDialog(QWidget *parent) :
     connect(ui->find_pushButton, SIGNAL(clicked()), this, SLOT(slotFind()));
     connect(ui->replace_pushButton, SIGNAL(clicked()), this, SLOT(slotReplace()));
     connect(ui->replaceAll_pushButton, SIGNAL(clicked()), this, SLOT(slotReplaceAll()));
+    connect(ui->find_lineEdit, SIGNAL(textEdited(QString)), this, SLOT(slotIncrementalSearch()));
+    connect(ui->case_checkBox, SIGNAL(toggled(bool)), this, SLOT(slotUpdateMatches()));
+    connect(ui->whole_checkBox, SIGNAL(toggled(bool)), this, SLOT(slotUpdateMatches()));
+    connect(ui->regExp_checkBox, SIGNAL(toggled(bool)), this, SLOT(slotUpdateMatches()));
+
+    m_countId = 0;
+    m_countTimer = new QTimer(this);
+    m_countTimer->setSingleShot(true);
+    m_countTimer->setInterval(150);
+    connect(m_countTimer, SIGNAL(timeout()), this, SLOT(slotCountMatches()));
+    m_counterThread = new QThread(this);
+    m_counter = new MatchCounter;
+    m_counter->moveToThread(m_counterThread);
+    connect(m_counterThread, SIGNAL(finished()), m_counter, SLOT(deleteLater()));
+    connect(this, SIGNAL(countMatches(int,QString,QString,int)),
+            m_counter, SLOT(count(int,QString,QString,int)));
+    connect(m_counter, SIGNAL(counted(int,int)), this, SLOT(slotCounted(int,int)));
+    m_counterThread->start(QThread::LowPriority);
 
     ui->find_lineEdit->setFocus();
 }
 
 FindReplaceDialog::~FindReplaceDialog()
 {
+    m_counter->setCurrent(-1);
+    m_counterThread->quit();
+    m_counterThread->wait();
     delete ui;
 }
 
@@ -49,18 +73,34 @@ void FindReplaceDialog::show()
 {
     ui->find_lineEdit->setFocus();
     QDialog::show();
+    slotUpdateMatches();
+}
+
+void FindReplaceDialog::hideEvent(QHideEvent *e)
+{
+    emit highlight(QString(), 0);
+    QDialog::hideEvent(e);
 }
 
 void FindReplaceDialog::setPage(Page *page)
 {
     if(page == 0) return;
+    if(page == m_page) return;
     if(m_page != 0) {
+        m_page->slotHighlightMatches(QString(), 0);
         disconnect(this, SIGNAL(find(QString,int)), m_page, SLOT(slotFind(QString,int)));
         disconnect(this, SIGNAL(replace(QString,QString,int,bool)), m_page, SLOT(slotReplace(QString,QString,int,bool)));
+        disconnect(this, SIGNAL(highlight(QString,int)), m_page, SLOT(slotHighlightMatches(QString,int)));
+        disconnect(m_page, SIGNAL(textChanged()), this, SLOT(slotUpdateMatches()));
     }
     m_page = page;
     connect(this, SIGNAL(find(QString,int)), m_page, SLOT(slotFind(QString,int)));
     connect(this, SIGNAL(replace(QString,QString,int,bool)), m_page, SLOT(slotReplace(QString,QString,int,bool)));
+    connect(this, SIGNAL(highlight(QString,int)), m_page, SLOT(slotHighlightMatches(QString,int)));
+    connect(m_page, SIGNAL(textChanged()), this, SLOT(slotUpdateMatches()));
+
+    if(isVisible())
+        slotUpdateMatches();
 }
 
 void FindReplaceDialog::slotFind()
@@ -89,6 +129,51 @@ void FindReplaceDialog::slotUpdateDirection()
 
 }
 
+void FindReplaceDialog::slotIncrementalSearch()
+{
+    // search again from where the current match starts, as the user types
+    if(m_page != 0 && !ui->find_lineEdit->text().isEmpty())
+    {
+        QTextCursor tc = m_page->textCursor();
+        tc.setPosition(tc.selectionStart());
+        m_page->setTextCursor(tc);
+        emit find(ui->find_lineEdit->text(), findFlags() & ~QTextDocument::FindBackward);
+    }
+    slotUpdateMatches();
+}
+
+void FindReplaceDialog::slotUpdateMatches()
+{
+    if(m_page == 0 || !isVisible())
+        return;
+
+    QString text = ui->find_lineEdit->text();
+    emit highlight(text, findFlags());
+
+    m_counter->setCurrent(++m_countId);
+    if(text.isEmpty())
+    {
+        m_countTimer->stop();
+        ui->count_label->clear();
+        return;
+    }
+    m_countTimer->start();
+}
+
+void FindReplaceDialog::slotCountMatches()
+{
+    if(m_page == 0)
+        return;
+    // the page text is copied once per pause in typing, not per keystroke
+    emit countMatches(m_countId, m_page->text(), ui->find_lineEdit->text(), findFlags());
+}
+
+void FindReplaceDialog::slotCounted(int id, int count)
+{
+    if(id == m_countId)
+        ui->count_label->setText(tr("%1 matches").arg(count));
+}
+
 int FindReplaceDialog::findFlags()
 {
     int flags = 0;
@@ -98,5 +183,7 @@ int FindReplaceDialog::findFlags()
         flags |= QTextDocument::FindBackward;
     if(ui->whole_checkBox->isChecked())
         flags |= QTextDocument::FindWholeWords;
+    if(ui->regExp_checkBox->isChecked())
+        flags |= Page::FindRegExp;
     return flags;
 }
@@ -23,6 +23,9 @@
 #include <QDialog>
 
 class Page;
+class MatchCounter;
+class QThread;
+class QTimer;
 
 namespace Ui {
 class FindReplaceDialog;
@@ -38,6 +41,9 @@ public:
 
     void show();
 
+protected:
+    void hideEvent(QHideEvent *e);
+
 public slots:
     void setPage(Page *page);
 
@@ -45,6 +51,8 @@ public slots:
 signals:
     void find(QString text,int flags);
     void replace(QString prev,QString next,int flags, bool all);
+    void highlight(QString text, int flags);
+    void countMatches(int id, QString text, QString pattern, int flags);
     
 
 private slots:
@@ -52,11 +60,19 @@ private slots:
     void slotReplace();
     void slotReplaceAll();
     void slotUpdateDirection();
+    void slotIncrementalSearch();
+    void slotUpdateMatches();
+    void slotCountMatches();
+    void slotCounted(int id, int count);
 private:
     Ui::FindReplaceDialog *ui;
     int findFlags();
 
     Page *m_page;
+    MatchCounter *m_counter;
+    QThread *m_counterThread;
+    QTimer *m_countTimer;
+    int m_countId;
 };
 
 #endif // FINDREPLACEDIALOG_H
@@ -19,91 +19,56 @@
 
 #include "highlighter.h"
 #include <QDebug>
-#include <QMessageBox>
-#include <QDialog>
 #include <QFile>
 #include <QApplication>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QSet>
 #include "codeparser.h"
 #include "qkide_global.h"
-
-Highlighter::Highlighter(QTextDocument *document) : QSyntaxHighlighter(document)
+#include "perfcounters.h"
+#include "stallwatchdog.h"
+
+Highlighter::Highlighter(QTextDocument *document) :
+    QSyntaxHighlighter(document),
+    m_readyBlocks(-1),
+    m_visibleFirst(0),
+    m_visibleLast(-1),
+    m_semanticBlockCount(0)
 {
     multiLineCommentFormat.setForeground(QColor("#999999"));
+    inactiveFormat.setForeground(QColor("#BBBBBB"));
 
     commentStartExpression = QRegExp("/\\*");
     commentEndExpression = QRegExp("\\*/");
 
-    QString defaultSyntaxPath = qApp->applicationDirPath() + THEME_DIR +
-                                "/syntax/white.syntax";
+    SyntaxDefinition *syntax = SyntaxDefinition::instance();
+    if(!syntax->isLoaded())
+        syntax->load(qApp->applicationDirPath() + THEME_DIR + "/syntax/white.syntax");
+    connect(syntax, SIGNAL(changed()), this, SLOT(slotSyntaxChanged()));
 
-    setSyntax(defaultSyntaxPath);
+    m_syntaxRules = syntax->rules();
+    updateSemanticFormats();
 }
 
-bool Highlighter::setSyntax(const QString &filePath)
+void Highlighter::slotSyntaxChanged()
 {
-    QString keywordColor;
-    QString keyword;
-    QTextCharFormat keywordFormat;
-
-    QFile file(filePath);
-    qDebug() << __FUNCTION__ << file.fileName();
+    m_syntaxRules = SyntaxDefinition::instance()->rules();
 
-    bool stop = false;
-    QString elementName, color,weight;
-    Rule rule;
-
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // element rules take their colors from the syntax
+    QVector<Rule> *ruleSets[] = { &m_permanentRules, &m_extraRules };
+    for(int i = 0; i < 2; i++)
     {
-        QMessageBox::critical(new QDialog,
-                              tr("Error"),
-                              tr("Error load syntax higlighter"),
-                              QMessageBox::Ok);
-    }
-
-    QTextStream input(&file);
-
-    m_permanentRules.clear();
-
-    while (!input.atEnd())
-    {
-        keywordColor = input.readLine();
-
-        if (keywordColor.contains("#rule"))
-        {
-            elementName = keywordColor.section(',',1,1);
-            color = keywordColor.section(',',2,2);
-            weight = keywordColor.section(',',3,3);
-            keywordFormat.setForeground(QBrush(QColor(color)));
-            if(weight.toLower() == "bold")
-                keywordFormat.setFontWeight(QFont::Bold);
-            else
-                keywordFormat.setFontWeight(QFont::Normal);
-        }
-
-        rule.elementName = elementName;
-        rule.format  = keywordFormat;
-        rule.pattern = QRegExp();
-
-        while (stop == false)
+        for(int r = 0; r < ruleSets[i]->count(); r++)
         {
-            keyword = input.readLine();
-
-            if (keyword == "stop")
-                stop = true;
-            else
-            {
-                rule.elementName = elementName;
-                rule.format  = keywordFormat;
-                rule.pattern = QRegExp(keyword);
-                m_permanentRules.append(rule);
-            }
+            Rule &rule = (*ruleSets[i])[r];
+            if(rule.elementName != "custom")
+                setElementFormat(&rule);
         }
-
-        if(rule.pattern.isEmpty())
-            m_permanentRules.append(rule);
-
-        stop = false;
     }
+
+    updateSemanticFormats();
+    rehighlight();
 }
 
 void Highlighter::addElements(QList<CodeParser::Element> elements, bool permanent)
@@ -118,8 +83,6 @@ void Highlighter::addElements(QList<CodeParser::Element> elements, bool permanen
 void Highlighter::addElement(const CodeParser::Element &element, bool permanent)
 {
     Highlighter::Rule rule;
-    QTextCharFormat textFormat;
-    QColor textColor;
 
     switch(element.type)
     {
@@ -140,20 +103,11 @@ void Highlighter::addElement(const CodeParser::Element &element, bool permanent)
         rule.elementName = "custom";
     }
 
-    switch(element.type)
-    {
-    case CodeParser::Element::Define:
-    case CodeParser::Element::Enum:
-    case CodeParser::Element::Function:
-    case CodeParser::Element::Typedef:
-        textColor = elementColor(rule.elementName);
-        break;
-    default:
-        textColor = QColor("#111");
-    }
-
-    textFormat.setForeground(QBrush(textColor));
-    rule.format = textFormat;
+    // color and weight come from the syntax, like slotSyntaxChanged() does
+    if(rule.elementName == "custom")
+        rule.format.setForeground(QBrush(QColor("#111")));
+    else
+        setElementFormat(&rule);
     QString regExpStr = "\\b(" + element.text + ")\\b";
     rule.pattern = QRegExp(regExpStr);
 
@@ -172,12 +126,114 @@ void Highlighter::clearElements(bool permanent)
 
 QColor Highlighter::elementColor(const QString &elementName)
 {
-    foreach(const Rule &rule, m_permanentRules)
+    foreach(const Rule &rule, m_syntaxRules)
         if(rule.elementName == elementName)
             return rule.format.foreground().color();
     return QColor();
 }
 
+void Highlighter::setElementFormat(Rule *rule)
+{
+    QBrush foreground = QBrush(QColor());
+    int weight = QFont::Normal;
+    foreach(const Rule &syntaxRule, m_syntaxRules)
+    {
+        if(syntaxRule.elementName == rule->elementName)
+        {
+            foreground = syntaxRule.format.foreground();
+            weight = syntaxRule.format.fontWeight();
+            break;
+        }
+    }
+    rule->format.setForeground(foreground);
+    rule->format.setFontWeight(weight);
+}
+
+void Highlighter::setInactiveLines(const QVector<bool> &inactive)
+{
+    QVector<bool> previous = m_inactive;
+    m_inactive = inactive;
+    if(document() == 0)
+        return;
+
+    // only the blocks that changed state need to be highlighted again
+    int count = qMax(previous.count(), inactive.count());
+    for(int i = 0; i < count; i++)
+    {
+        if(previous.value(i) != inactive.value(i))
+            rehighlightBlock(document()->findBlockByNumber(i));
+    }
+}
+
+void Highlighter::setSemanticTokens(const QList<SemanticToken> &tokens)
+{
+    QHash<int, QList<SemanticToken> > previous = m_semanticTokens;
+    m_semanticTokens.clear();
+    foreach(const SemanticToken &token, tokens)
+        m_semanticTokens[token.line - 1].append(token);
+    if(document() == 0)
+        return;
+    m_semanticBlockCount = document()->blockCount();
+
+    QSet<int> lines = previous.keys().toSet() + m_semanticTokens.keys().toSet();
+    foreach(int line, lines)
+    {
+        if(previous.value(line) != m_semanticTokens.value(line))
+            rehighlightBlock(document()->findBlockByNumber(line));
+    }
+}
+
+void Highlighter::clearSemanticTokens(int firstBlock, int lastBlock)
+{
+    if(m_semanticTokens.isEmpty() || document() == 0)
+        return;
+
+    // the changed blocks were already highlighted with the old tokens
+    bool stale = false;
+    if(document()->blockCount() != m_semanticBlockCount)
+    {
+        // every line below the edit moved
+        m_semanticTokens.clear();
+        stale = true;
+    }
+    for(int i = firstBlock; i <= lastBlock; i++)
+    {
+        if(m_semanticTokens.remove(i) > 0)
+            stale = true;
+    }
+    if(!stale)
+        return;
+
+    QTextBlock block = document()->findBlockByNumber(firstBlock);
+    while(block.isValid() && block.blockNumber() <= lastBlock)
+    {
+        rehighlightBlock(block);
+        block = block.next();
+    }
+}
+
+void Highlighter::updateSemanticFormats()
+{
+    // themes color these kinds with rules that have no pattern
+    static const char *elementNames[SemanticToken::KindCount] = {
+        "local", "parameter", "define", "field", "enum", "typedef"
+    };
+
+    for(int kind = 0; kind < SemanticToken::KindCount; kind++)
+    {
+        m_semanticEnabled[kind] = false;
+        foreach(const Rule &rule, m_syntaxRules)
+        {
+            if(rule.elementName == elementNames[kind])
+            {
+                m_semanticFormats[kind] = rule.format;
+                m_semanticEnabled[kind] = true;
+                break;
+            }
+        }
+    }
+}
+
 void Highlighter::applyRuleToText(const Rule &rule, const QString &text)
 {
     if(rule.pattern.isEmpty())
@@ -193,14 +249,77 @@ void Highlighter::applyRuleToText(const Rule &rule, const QString &text)
     }
 }
 
+void Highlighter::setReadyBlocks(int count)
+{
+    m_readyBlocks = count;
+}
+
+void Highlighter::setVisibleBlocks(int first, int last)
+{
+    if(first == m_visibleFirst && last == m_visibleLast)
+        return;
+    m_visibleFirst = first;
+    m_visibleLast = last;
+
+    if(m_readyBlocks < 0 || document() == 0)
+        return;
+    QTextBlock block = document()->findBlockByNumber(qMax(first, m_readyBlocks));
+    while(block.isValid() && block.blockNumber() <= last)
+    {
+        rehighlightBlock(block);
+        block = block.next();
+    }
+}
+
+bool Highlighter::highlightMore(int count)
+{
+    if(m_readyBlocks < 0 || document() == 0)
+        return false;
+
+    int from = m_readyBlocks;
+    int to = qMin(from + count, document()->blockCount());
+    m_readyBlocks = to;
+
+    QTextBlock block = document()->findBlockByNumber(from);
+    while(block.isValid() && block.blockNumber() < to)
+    {
+        rehighlightBlock(block);
+        block = block.next();
+    }
+
+    if(to < document()->blockCount())
+        return true;
+    m_readyBlocks = -1;
+    return false;
+}
+
 void Highlighter::highlightBlock(const QString &text)
 {
+    // deferred blocks keep their state so nothing cascades past them
+    if(m_readyBlocks >= 0)
+    {
+        int number = currentBlock().blockNumber();
+        if(number >= m_readyBlocks && (number < m_visibleFirst || number > m_visibleLast))
+            return;
+    }
+
+    PerfCounters::Scope scope(PerfCounters::HighlightBlock);
+    StallWatchdog::Phase phase("Highlighter::highlightBlock");
     foreach (const Rule &rule, m_extraRules)
         applyRuleToText(rule, text);
 
-    foreach (Rule rule, m_permanentRules)
+    foreach (const Rule &rule, m_syntaxRules)
         applyRuleToText(rule, text);
 
+    foreach (const Rule &rule, m_permanentRules)
+        applyRuleToText(rule, text);
+
+    foreach(const SemanticToken &token, m_semanticTokens.value(currentBlock().blockNumber()))
+    {
+        if(token.kind >= 0 && token.kind < SemanticToken::KindCount && m_semanticEnabled[token.kind])
+            setFormat(token.column, token.length, m_semanticFormats[token.kind]);
+    }
+
     setCurrentBlockState(0);
 
     int startIndex = 0;
@@ -229,4 +348,7 @@ void Highlighter::highlightBlock(const QString &text)
         setFormat(startIndex, commentLength, multiLineCommentFormat);
         startIndex = commentStartExpression.indexIn(text, startIndex + commentLength);
      }
+
+    if(m_inactive.value(currentBlock().blockNumber()))
+        setFormat(0, text.length(), inactiveFormat);
 }
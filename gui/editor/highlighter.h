@@ -22,6 +22,8 @@
 
 #include <QSyntaxHighlighter>
 #include "codeparser.h"
+#include "semanticindexer.h"
+#include "syntaxdefinition.h"
 
 class Highlighter;
 
@@ -36,16 +38,9 @@ public:
         Define,
         Function
     };
-    class Rule
-    {
-    public:
-        QString elementName;
-        QRegExp pattern;
-        QTextCharFormat format;
-    };
-    Highlighter(QTextDocument *document);
+    typedef SyntaxDefinition::Rule Rule;
 
-    bool setSyntax(const QString &filePath);
+    Highlighter(QTextDocument *document);
 
     void addElements(QList<CodeParser::Element> elements, bool permanent = false);
     void addElement(const CodeParser::Element &element, bool permanent = false);
@@ -57,6 +52,16 @@ public:
     //static void endPermanentRules() { m_permanentRule = false;}
 
     QColor elementColor(const QString &elementName);
+    void setInactiveLines(const QVector<bool> &inactive);
+    void setSemanticTokens(const QList<SemanticToken> &tokens);
+    // tokens are keyed by line, edits make them stale until the next index
+    void clearSemanticTokens(int firstBlock, int lastBlock);
+
+    // blocks past readyBlocks are skipped unless they are on screen, -1
+    // highlights everything
+    void setReadyBlocks(int count);
+    void setVisibleBlocks(int first, int last);
+    bool highlightMore(int count);
 
 protected:
     void highlightBlock(const QString &text);
@@ -65,6 +70,9 @@ protected:
 public slots:
     //void addKeywords(QStringList keywords, const QColor &color);
 
+private slots:
+    void slotSyntaxChanged();
+
 
 private:
     struct Keywords {
@@ -72,6 +80,7 @@ private:
         QColor color;
     };
 
+    QVector<Rule> m_syntaxRules;
     QVector<Rule> m_permanentRules;
     QVector<Rule> m_extraRules;
     bool m_permanentRule;
@@ -82,6 +91,17 @@ private:
     QTextCharFormat keywordFormat;
     QTextCharFormat classFormat;
     QTextCharFormat multiLineCommentFormat;
+    QTextCharFormat inactiveFormat;
+
+    int m_readyBlocks;
+    int m_visibleFirst;
+    int m_visibleLast;
+
+    QVector<bool> m_inactive;
+    QHash<int, QList<SemanticToken> > m_semanticTokens;
+    int m_semanticBlockCount;
+    QTextCharFormat m_semanticFormats[SemanticToken::KindCount];
+    bool m_semanticEnabled[SemanticToken::KindCount];
 
     QString curLanguage;
 
@@ -89,6 +109,8 @@ private:
 
 //    void setupPermanentRules();
     void applyRuleToText(const Rule &rule, const QString &text);
+    void setElementFormat(Rule *rule);
+    void updateSemanticFormats();
 };
 
 #endif // HIGHLIGHTER_H
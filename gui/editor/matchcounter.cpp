@@ -0,0 +1,61 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "matchcounter.h"
+#include "page.h"
+
+MatchCounter::MatchCounter(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void MatchCounter::count(int id, const QString &text, const QString &pattern, int flags)
+{
+    if(m_current.load() != id)
+        return;
+
+    QRegExp rx = Page::findRegExp(pattern, flags);
+    int count = 0;
+
+    // line by line, the way the page finds and highlights matches
+    int lineStart = 0;
+    int lines = 0;
+    while(lineStart <= text.size() && !pattern.isEmpty())
+    {
+        int lineEnd = text.indexOf('\n', lineStart);
+        if(lineEnd == -1)
+            lineEnd = text.size();
+        QString line = text.mid(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        int pos = 0;
+        while((pos = rx.indexIn(line, pos)) != -1)
+        {
+            int length = rx.matchedLength();
+            if(length > 0)
+                count++;
+            pos += qMax(1, length);
+        }
+
+        if((++lines & 0xFF) == 0 && m_current.load() != id)
+            return;
+    }
+
+    emit counted(id, count);
+}
@@ -0,0 +1,48 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATCHCOUNTER_H
+#define MATCHCOUNTER_H
+
+#include <QObject>
+#include <QAtomicInt>
+
+/*
+ * Counts the matches of a find pattern from a worker thread. Counting
+ * stops early when a newer request id is set with setCurrent().
+ */
+class MatchCounter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MatchCounter(QObject *parent = 0);
+
+    void setCurrent(int id) { m_current.store(id); }
+
+signals:
+    void counted(int id, int count);
+
+public slots:
+    void count(int id, const QString &text, const QString &pattern, int flags);
+
+private:
+    QAtomicInt m_current;
+};
+
+#endif // MATCHCOUNTER_H
@@ -21,6 +21,10 @@
 #include "highlighter.h"
 #include "completer.h"
 #include "codetip.h"
+#include "occurrenceindex.h"
+#include "perfcounters.h"
+#include "stallwatchdog.h"
+#include "applog.h"
 
 #include "qkide_global.h"
 
@@ -32,6 +36,7 @@
 #include <QAbstractItemModel>
 #include <QStringListModel>
 #include <QKeyEvent>
+#include <QMouseEvent>
 #include <QFile>
 #include <QScrollBar>
 #include <QTextStream>
@@ -41,13 +46,24 @@
 #include <QListWidget>
 #include <QToolTip>
 #include <QKeyEvent>
+#include <QMouseEvent>
 #include <QAbstractItemModel>
 #include <QStandardItemModel>
+#include <QTimer>
+#include <QRegExp>
 
 Page::Page(const QString &name, QWidget *parent) :
     QPlainTextEdit(parent),
     m_name(name),
-    m_lastTextCursorPosition(0)
+    m_lastTextCursorPosition(0),
+    m_occurrenceIndex(0),
+    m_loadPos(0),
+    m_loading(false),
+    m_trackEdits(true),
+    m_revision(0),
+    m_pendingLine(0),
+    m_pendingColumn(0),
+    m_searchActive(false)
 {
     QPalette p = palette();
     p.setColor(QPalette::Base, Qt::white);
@@ -63,6 +79,10 @@ Page::Page(const QString &name, QWidget *parent) :
 
     m_highligher = new Highlighter(this->document());
 
+    m_highlightTimer = new QTimer(this);
+    m_highlightTimer->setInterval(0);
+    connect(m_highlightTimer, SIGNAL(timeout()), this, SLOT(slotHighlightChunk()));
+
     m_completer = new Completer();
     m_completer->setWidget(this);
     m_completer->setCompletionMode(QCompleter::PopupCompletion);
@@ -87,6 +107,28 @@ Page::Page(const QString &name, QWidget *parent) :
     //highlightCurrentLine();
 
     connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(braceMatch()));
+    connect(document(), SIGNAL(contentsChange(int,int,int)),
+            this, SLOT(slotContentsChange(int,int,int)));
+
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(SearchUpdateDelay);
+    connect(m_searchTimer, SIGNAL(timeout()), this, SLOT(updateSearchSelections()));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), m_searchTimer, SLOT(start()));
+    connect(this, SIGNAL(textChanged()), m_searchTimer, SLOT(start()));
+
+    m_preprocessTimer = new QTimer(this);
+    m_preprocessTimer->setSingleShot(true);
+    m_preprocessTimer->setInterval(PreprocessDelay);
+    connect(m_preprocessTimer, SIGNAL(timeout()), this, SLOT(updateInactiveLines()));
+    connect(this, SIGNAL(textChanged()), m_preprocessTimer, SLOT(start()));
+
+    m_semanticIndexer = 0;
+    m_semanticTimer = new QTimer(this);
+    m_semanticTimer->setSingleShot(true);
+    m_semanticTimer->setInterval(SemanticDelay);
+    connect(m_semanticTimer, SIGNAL(timeout()), this, SLOT(requestSemanticTokens()));
+    connect(this, SIGNAL(textChanged()), m_semanticTimer, SLOT(start()));
 //    connect(this, SIGNAL(textChanged()), this, SLOT(slotTextChanged()));
 //    connect(this, SIGNAL(textChanged()), this, SIGNAL(keyPressed()));
 
@@ -100,28 +142,378 @@ QString Page::name()
 
 QString Page::text()
 {
+    if(m_loading)
+        return m_loadText;
     return toPlainText();
 }
 
+void Page::loadText(const QString &text)
+{
+    m_trackEdits = false;
+
+    if(text.size() < LoadChunkThreshold)
+    {
+        setPlainText(text);
+        m_revision = document()->revision();
+        m_trackEdits = true;
+        emit loaded();
+        return;
+    }
+
+    // big files are inserted a chunk per event loop iteration with the
+    // highlighter detached, so the window keeps responding while loading
+    m_loadText = text;
+    m_loadPos = 0;
+    m_loading = true;
+
+    m_highlightTimer->stop();
+    m_highligher->setDocument(0);
+    setUndoRedoEnabled(false);
+    clear();
+
+    QTimer::singleShot(0, this, SLOT(slotLoadChunk()));
+}
+
+void Page::slotLoadChunk()
+{
+    if(!m_loading)
+        return;
+
+    int end = m_loadPos + LoadChunkSize;
+    if(end < m_loadText.size())
+    {
+        int lineEnd = m_loadText.indexOf('\n', end);
+        end = (lineEnd == -1 ? m_loadText.size() : lineEnd + 1);
+    }
+    else
+        end = m_loadText.size();
+
+    QTextCursor tc(document());
+    tc.movePosition(QTextCursor::End);
+    tc.insertText(m_loadText.mid(m_loadPos, end - m_loadPos));
+    m_loadPos = end;
+
+    if(m_loadPos < m_loadText.size())
+    {
+        QTimer::singleShot(0, this, SLOT(slotLoadChunk()));
+        return;
+    }
+
+    m_loading = false;
+    m_loadText.clear();
+    setUndoRedoEnabled(true);
+    document()->setModified(false);
+    moveCursor(QTextCursor::Start);
+
+    QTimer::singleShot(0, this, SLOT(slotAttachHighlighter()));
+    m_revision = document()->revision();
+    m_trackEdits = true;
+    if(m_pendingLine > 0)
+        goToLine(m_pendingLine, m_pendingColumn);
+    emit loaded();
+}
+
+void Page::slotAttachHighlighter()
+{
+    if(m_highligher->document() == 0)
+    {
+        // the blocks on screen first, then the rest a chunk per idle
+        // event loop iteration
+        m_highligher->setReadyBlocks(0);
+        m_highligher->setVisibleBlocks(firstVisibleBlock().blockNumber(),
+                                       cursorForPosition(viewport()->rect().bottomLeft()).blockNumber());
+        m_highligher->setDocument(document());
+        m_highlightTimer->start();
+    }
+    updateInactiveLines();
+    requestSemanticTokens();
+}
+
+void Page::slotHighlightChunk()
+{
+    m_highligher->setVisibleBlocks(firstVisibleBlock().blockNumber(),
+                                   cursorForPosition(viewport()->rect().bottomLeft()).blockNumber());
+    if(!m_highligher->highlightMore(HighlightChunkBlocks))
+        m_highlightTimer->stop();
+}
+
+void Page::setPreprocessor(const Preprocessor &preprocessor)
+{
+    m_preprocessor = preprocessor;
+    updateInactiveLines();
+}
+
+void Page::setSemanticIndexer(SemanticIndexer *indexer, const QString &filePath,
+                              const QStringList &arguments)
+{
+    if(m_semanticIndexer != 0)
+        disconnect(m_semanticIndexer, 0, this, 0);
+
+    m_semanticIndexer = indexer;
+    m_semanticPath = filePath;
+    m_semanticArguments = arguments;
+    if(m_semanticIndexer != 0)
+    {
+        connect(m_semanticIndexer, SIGNAL(indexed(QString,int,QList<SemanticToken>)),
+                this, SLOT(slotSemanticIndexed(QString,int,QList<SemanticToken>)));
+    }
+    requestSemanticTokens();
+}
+
+void Page::requestSemanticTokens()
+{
+    if(m_loading || m_semanticIndexer == 0)
+        return;
+    m_semanticIndexer->index(m_semanticPath, toPlainText(), m_semanticArguments,
+                             document()->revision());
+}
+
+void Page::slotSemanticIndexed(const QString &filePath, int revision,
+                               const QList<SemanticToken> &tokens)
+{
+    // results for an older text would land on the wrong columns
+    if(filePath != m_semanticPath || revision != document()->revision())
+        return;
+    m_highligher->setSemanticTokens(tokens);
+}
+
+void Page::updateInactiveLines()
+{
+    if(m_loading || !m_preprocessor.isValid())
+        return;
+    m_highligher->setInactiveLines(m_preprocessor.inactiveLines(toPlainText()));
+}
+
+void Page::goToLine(int line, int column)
+{
+    if(m_loading)
+    {
+        m_pendingLine = line;
+        m_pendingColumn = column;
+        return;
+    }
+    m_pendingLine = 0;
+
+    QTextBlock block = document()->findBlockByNumber(line - 1);
+    if(!block.isValid())
+        return;
+
+    QTextCursor tc(block);
+    tc.setPosition(block.position() + qMin(column, block.length() - 1));
+    setTextCursor(tc);
+    centerCursor();
+    setFocus();
+}
+
+void Page::slotContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // highlighting also reports changes, but only edits bump the revision
+    if(document()->revision() == m_revision)
+        return;
+    m_revision = document()->revision();
+
+    // changes touching the end of the document count the last separator
+    int excess = position + charsAdded - (document()->characterCount() - 1);
+    if(excess > 0)
+    {
+        charsAdded -= excess;
+        charsRemoved = qMax(0, charsRemoved - excess);
+    }
+
+    m_highligher->clearSemanticTokens(document()->findBlock(position).blockNumber(),
+                                      document()->findBlock(position + charsAdded).blockNumber());
+
+    if(!m_trackEdits)
+        return;
+
+    QString text;
+    if(charsAdded > 0)
+    {
+        QTextCursor tc(document());
+        tc.setPosition(position);
+        tc.setPosition(position + charsAdded, QTextCursor::KeepAnchor);
+        text = tc.selectedText();
+        text.replace(QChar::ParagraphSeparator, '\n');
+    }
+
+    emit edited(position, charsRemoved, text);
+}
+
 void Page::slotFind(const QString &text, int flags)
 {
+    if(flags & FindRegExp)
+    {
+        QTextDocument::FindFlags docFlags = (QTextDocument::FindFlag) (flags & QTextDocument::FindBackward);
+        QTextCursor tc = document()->find(findRegExp(text, flags), textCursor(), docFlags);
+        if(!tc.isNull())
+            setTextCursor(tc);
+        return;
+    }
     find(text, (QTextDocument::FindFlag) flags);
 }
 
 void Page::slotReplace(const QString &prev, const QString &current, int flags, bool all)
 {
-    QTextCursor tc = textCursor();
+    if(prev.isEmpty())
+        return;
+
+    QRegExp rx = findRegExp(prev, flags);
+    bool captures = (flags & FindRegExp);
+
     if(!all)
     {
+        QTextCursor tc = textCursor();
         if(tc.selectedText() != "")
-            textCursor().insertText(current);
+        {
+            if(captures && rx.exactMatch(tc.selectedText()))
+                tc.insertText(expandCaptures(current, rx));
+            else
+                tc.insertText(current);
+        }
+        return;
     }
-    else
+
+    // find every match first, a block at a time like find() and the
+    // search highlights, so ^ and $ anchor at lines and nothing spans them
+    QList<int> positions;
+    QList<int> lengths;
+    QStringList replacements;
+    for(QTextBlock block = document()->begin(); block.isValid(); block = block.next())
+    {
+        QString text = block.text();
+        int pos = 0;
+        while((pos = rx.indexIn(text, pos)) != -1)
+        {
+            int length = rx.matchedLength();
+            if(length == 0)
+            {
+                pos++;
+                continue;
+            }
+            positions.append(block.position() + pos);
+            lengths.append(length);
+            replacements.append(captures ? expandCaptures(current, rx) : current);
+            pos += length;
+        }
+    }
+
+    if(positions.isEmpty())
+        return;
+
+    // then apply them from the end so earlier positions stay valid, all in
+    // one edit block: one undo step, one relayout and one textChanged()
+    QTextCursor tc(document());
+    tc.beginEditBlock();
+    for(int i = positions.count() - 1; i >= 0; i--)
+    {
+        tc.setPosition(positions[i]);
+        tc.setPosition(positions[i] + lengths[i], QTextCursor::KeepAnchor);
+        tc.insertText(replacements[i]);
+    }
+    tc.endEditBlock();
+
+    emit info(tr("%1 occurrences replaced.").arg(positions.count()));
+}
+
+void Page::slotHighlightMatches(const QString &text, int flags)
+{
+    m_searchActive = !text.isEmpty();
+    if(m_searchActive)
+        m_searchRegExp = findRegExp(text, flags);
+    updateSearchSelections();
+}
+
+void Page::updateSearchSelections()
+{
+    if(!m_searchActive && m_searchSelections.isEmpty())
+        return;
+    m_searchSelections.clear();
+
+    // only the blocks on screen are matched, scrolling brings in the rest
+    if(m_searchActive && m_searchRegExp.isValid())
+    {
+        QTextCharFormat format;
+        format.setBackground(QColor("#FFD27F"));
+
+        QTextBlock block = firstVisibleBlock();
+        qreal top = blockBoundingGeometry(block).translated(contentOffset()).top();
+        int bottom = viewport()->rect().bottom();
+        while(block.isValid() && top <= bottom &&
+              m_searchSelections.count() < MaxSearchSelections)
+        {
+            if(block.isVisible())
+            {
+                QString text = block.text();
+                int pos = 0;
+                while((pos = m_searchRegExp.indexIn(text, pos)) != -1)
+                {
+                    int length = m_searchRegExp.matchedLength();
+                    if(length == 0)
+                    {
+                        pos++;
+                        continue;
+                    }
+                    QTextEdit::ExtraSelection selection;
+                    selection.cursor = QTextCursor(document());
+                    selection.cursor.setPosition(block.position() + pos);
+                    selection.cursor.setPosition(block.position() + pos + length,
+                                                 QTextCursor::KeepAnchor);
+                    selection.format = format;
+                    m_searchSelections.append(selection);
+                    pos += length;
+                }
+            }
+            top += blockBoundingRect(block).height();
+            block = block.next();
+        }
+    }
+
+    updateExtraSelections();
+}
+
+void Page::updateExtraSelections()
+{
+    setExtraSelections(m_searchSelections + m_braceSelections);
+}
+
+QRegExp Page::findRegExp(const QString &text, int flags)
+{
+    QString pattern = (flags & FindRegExp) ? text : QRegExp::escape(text);
+    if(flags & QTextDocument::FindWholeWords)
+        pattern = "\\b(?:" + pattern + ")\\b";
+
+    Qt::CaseSensitivity cs = (flags & QTextDocument::FindCaseSensitively) ?
+                             Qt::CaseSensitive : Qt::CaseInsensitive;
+    return QRegExp(pattern, cs, QRegExp::RegExp2);
+}
+
+QString Page::expandCaptures(const QString &replacement, const QRegExp &rx)
+{
+    // \1..\9 are replaced by the captured text, \\ by a backslash
+    QString result;
+    result.reserve(replacement.size());
+    for(int i = 0; i < replacement.size(); i++)
     {
-        textCursor().movePosition(QTextCursor::Start);
-        while(find(prev, (QTextDocument::FindFlag) flags))
-            textCursor().insertText(current);
+        QChar c = replacement.at(i);
+        if(c == '\\' && i + 1 < replacement.size())
+        {
+            QChar next = replacement.at(i + 1);
+            if(next.isDigit() && next != '0')
+            {
+                result.append(rx.cap(next.digitValue()));
+                i++;
+                continue;
+            }
+            if(next == '\\')
+            {
+                result.append(next);
+                i++;
+                continue;
+            }
+        }
+        result.append(c);
     }
+    return result;
 }
 
 
@@ -188,10 +580,30 @@ void Page::wheelEvent(QWheelEvent *e)
 
 void Page::mousePressEvent(QMouseEvent *e)
 {
+    if(e->button() == Qt::LeftButton && (e->modifiers() & Qt::ControlModifier))
+    {
+        QString symbol = wordUnderCursor(cursorForPosition(e->pos()));
+        if(!symbol.isEmpty())
+        {
+            emit definitionRequested(symbol);
+            return;
+        }
+    }
+
     QPlainTextEdit::mousePressEvent(e);
     m_lastTextCursorPosition = textCursor().position();
 }
 
+QString Page::wordUnderCursor(QTextCursor tc)
+{
+    tc.clearSelection();
+    tc.select(QTextCursor::WordUnderCursor);
+    QString word = tc.selectedText();
+    if(word.isEmpty() || !(word[0].isLetter() || word[0] == '_'))
+        return QString();
+    return word;
+}
+
 QTextLine Page::currentTextLine(const QTextCursor &cursor)
 {
     const QTextBlock block = cursor.block();
@@ -206,151 +618,144 @@ QTextLine Page::currentTextLine(const QTextCursor &cursor)
     return layout->lineForTextPosition(relativePos);
 }
 
-QStringList Page::parseFunctionArgs(const QString &args)
+bool Page::findCall(QString *functionName, int *openPosition, int *argument)
 {
-    QString arg;
-    QStringList list;
-    int parenthesesDepth = 0;
-    bool isString = false;
-    for(int i = 0; i < args.size(); i++)
+    // a few lines back are enough for calls split over several lines
+    QTextCursor tc = textCursor();
+    QTextBlock block = tc.block();
+    for(int i = 0; i < MaxCallLines && block.previous().isValid(); i++)
+        block = block.previous();
+    int start = block.position();
+    QString text;
+    for(; block.isValid() && block.position() <= tc.position(); block = block.next())
+        text += block.text() + '\n';
+    text.truncate(tc.position() - start);
+
+    // open calls at the cursor, innermost last
+    QList< QPair<int,int> > calls;
+    bool inString = false;
+    bool inChar = false;
+    for(int i = 0; i < text.size(); i++)
     {
-        char c = args.at(i).toLatin1();
-
-        if(c == '"')
-            isString = !isString;
-        else if(c == '(')
-            parenthesesDepth++;
-        else if(c == ')')
-            parenthesesDepth--;
-
-        if(c == ',' && !isString && parenthesesDepth == 0)
+        QChar c = text.at(i);
+        if(inString || inChar)
+        {
+            if(c == '\\')
+                i++;
+            else if((inString && c == '"') || (inChar && c == '\'') || c == '\n')
+                inString = inChar = false;
+        }
+        else if(c == '"')
+            inString = true;
+        else if(c == '\'')
+            inChar = true;
+        else if(c == '/' && i + 1 < text.size() && text.at(i+1) == '/')
         {
-            list.append(arg);
-            arg.clear();
+            while(i < text.size() && text.at(i) != '\n')
+                i++;
         }
-        else
-            arg.append(c);
+        else if(c == '(')
+            calls.append(qMakePair(i, 0));
+        else if(c == ')' && !calls.isEmpty())
+            calls.removeLast();
+        else if(c == ',' && !calls.isEmpty())
+            calls.last().second++;
+        else if(c == ';' || c == '{' || c == '}')
+            calls.clear();
     }
-    list.append(arg);
-    return list;
-}
 
-int Page::functionArg(int cursorPos, QStringList args)
-{
-    int i, count;
-    if(args.count() == 0 || (args.count() == 1 && args[0] == ""))
-        return 0;
-    for(i = 0, count = 0; i < args.count(); i++)
+    while(!calls.isEmpty())
     {
-        count += args[i].size();
-        if(cursorPos <= (count+1))
-            return i;
+        QPair<int,int> call = calls.takeLast();
+        int end = call.first;
+        while(end > 0 && text.at(end - 1).isSpace())
+            end--;
+        int begin = end;
+        while(begin > 0 && (text.at(begin - 1).isLetterOrNumber() || text.at(begin - 1) == '_'))
+            begin--;
+        if(begin == end)
+            continue;
+
+        *functionName = text.mid(begin, end - begin);
+        *openPosition = start + call.first;
+        *argument = call.second;
+        return true;
     }
-    return i-1;
+    return false;
 }
 
-
 bool Page::setFunctionTooltip(bool show)
 {
-    if(!show)
+    PerfCounters::Scope scope(PerfCounters::FunctionTooltip);
+    QString functionName;
+    int openPosition;
+    int argument;
+    const Completer::Signature *signature = 0;
+    if(show && findCall(&functionName, &openPosition, &argument))
+        signature = m_completer->signature(functionName);
+
+    if(signature == 0)
     {
         m_codeTip->hide();
         return false;
     }
 
-    QTextCursor tc = textCursor();
-    int curPos = tc.position();
-    tc.movePosition(QTextCursor::StartOfLine);
-    int linePos = tc.position();
-
-    curPos -= linePos;
+    QString codeTipText;
+    int last = 0;
+    if(argument < signature->parameters.count())
+    {
+        QPair<int,int> span = signature->parameters.at(argument);
+        codeTipText = signature->prototype.left(span.first).toHtmlEscaped() + "<b>" +
+                      signature->prototype.mid(span.first, span.second).toHtmlEscaped() + "</b>";
+        last = span.first + span.second;
+    }
+    codeTipText += signature->prototype.mid(last).toHtmlEscaped();
 
-    QString line = lineUnderCursor(tc);
+    if(m_occurrenceIndex != 0 && m_occurrenceIndex->isReady())
+        codeTipText += tr("  <i>%1 calls</i>").arg(m_occurrenceIndex->callCount(functionName));
 
-    QVector< QPair<int,int> > parenthesesPairs;
+    QTextCursor openCursor = textCursor();
+    openCursor.setPosition(openPosition + 1);
+    QPoint toolTipPos = viewport()->mapToGlobal(cursorRect(openCursor).topRight());
+    toolTipPos.setY(toolTipPos.y() - (font().pointSize()*2+6));
 
-    QList< QPair<int,int> > validPairs;
+    m_codeTip->setFont(font());
+    m_codeTip->setText(codeTipText);
+    m_codeTip->move(toolTipPos.x(), toolTipPos.y());
+    m_codeTip->show();
+    return true;
+}
 
-    parenthesesPairs.resize(32);
+void Page::keyPressEvent(QKeyEvent *e)
+{
+    if(m_loading)
+        return;
 
-    int depthLevel = 0;
-    int countForward = 0;
-    int countBackward = 0;
+    PerfCounters::keystroke();
 
-    for(int i = 0; i < line.size(); i++)
+    if(e->key() == Qt::Key_F12)
     {
-        char c = line.at(i).toLatin1();
-        if(c == '(')
-        {
-            parenthesesPairs[depthLevel].first = i;
-            depthLevel++;
-            countForward++;
-        }
-        else if(c == ')')
+        QString symbol = wordUnderCursor(textCursor());
+        if(!symbol.isEmpty())
         {
-            depthLevel--;
-            parenthesesPairs[depthLevel].second = i;
-            countBackward++;
-            validPairs.append(parenthesesPairs[depthLevel]);
+            if((e->modifiers() & Qt::ShiftModifier) && (e->modifiers() & Qt::ControlModifier))
+                emit callersRequested(symbol);
+            else if(e->modifiers() & Qt::ShiftModifier)
+                emit referencesRequested(symbol);
+            else
+                emit definitionRequested(symbol);
         }
+        return;
     }
 
-    int countPairs = qMin(countForward, countBackward);
-    parenthesesPairs.resize(countPairs);
-
-    for(int i = 0; i < validPairs.count(); i++)
+    if(isReadOnly() && (e->modifiers() == Qt::NoModifier))
     {
-        int forwardPos = validPairs[i].first;
-        int backwardPos = validPairs[i].second;
-
-        if(curPos >= forwardPos && curPos <= backwardPos)
+        // let read-only pages still be browsed with the keyboard
+        if(e->text().isEmpty())
         {
-            QString contents = line.mid(forwardPos + 1, backwardPos - forwardPos - 1);
-            QStringList arguments = parseFunctionArgs(contents);
-
-            QTextCursor lineCursor = textCursor();
-            lineCursor.setPosition(linePos + forwardPos - 1);
-            lineCursor.select(QTextCursor::WordUnderCursor);
-            QString functionName = lineCursor.selectedText();
-
-            QList<CodeParser::Element> functions = completer()->functions();
-            int idx = CodeParser::hasElement(functionName, functions);
-            if(idx != -1)
-            {
-                QFontMetrics fm(font());
-                lineCursor.setPosition(linePos + forwardPos + 1);
-
-                QPoint toolTipPos = viewport()->mapToGlobal(cursorRect(lineCursor).topRight());
-                toolTipPos.setY(toolTipPos.y() - (font().pointSize()*2+6));
-
-                QString prototype = functions[idx].prototype;
-                QString temp = prototype.mid(prototype.indexOf('('));
-                temp.remove(0, 1).chop(1);
-                QStringList prototypeArgs = parseFunctionArgs(temp);
-
-
-                QString codeTipText = prototype;
-                int argNum = functionArg(curPos - forwardPos, arguments);
-
-                if(argNum != -1 && argNum < prototypeArgs.count() && prototypeArgs[argNum] != "")
-                    codeTipText.replace(prototypeArgs[argNum], "<b>" + prototypeArgs[argNum] + "</b>");
-
-                m_codeTip->setFont(font());
-                m_codeTip->setText(codeTipText);
-                m_codeTip->move(toolTipPos.x(), toolTipPos.y());
-                m_codeTip->show();
-                return true;
-            }
+            QPlainTextEdit::keyPressEvent(e);
+            return;
         }
-    }
-    m_codeTip->hide();
-    return false;
-}
-
-void Page::keyPressEvent(QKeyEvent *e)
-{
-    if(isReadOnly() && (e->modifiers() == Qt::NoModifier))
-    {
         qDebug() << "can't edit, read-only file!";
         emit info(tr("This is a read-only project.\n"
                      "To change it you need to re-save it to another location."));
@@ -373,6 +778,18 @@ void Page::keyPressEvent(QKeyEvent *e)
         }
     }
 
+    if(e->key() == Qt::Key_Space && (e->modifiers() & Qt::ControlModifier) &&
+       (e->modifiers() & Qt::ShiftModifier))
+    {
+        setFunctionTooltip();
+        return;
+    }
+    if(e->key() == Qt::Key_Escape && m_codeTip->isVisible())
+    {
+        m_codeTip->hide();
+        return;
+    }
+
     bool bypassCompleter = false;
 
     bool requestCompleter = ((e->modifiers() & Qt::ControlModifier) && e->key() == Qt::Key_Space);
@@ -386,6 +803,9 @@ void Page::keyPressEvent(QKeyEvent *e)
     if(eventText.count() > 0)
         onChar(eventText.at(0).toLatin1());
 
+    if(eventText == "(" || eventText == ",")
+        setFunctionTooltip(!m_completer->popup()->isVisible());
+
     //FIXME textChanged should be used instead (?)
     bool emitKeyPressed = !m_completer->popup()->isVisible() &&
                            e->modifiers() == Qt::NoModifier &&
@@ -506,6 +926,7 @@ void Page::keyPressEvent(QKeyEvent *e)
 //        bypassCompleter = true;
 //    }
 
+    PerfCounters::Scope scope(PerfCounters::CompleterFilter);
     if (completionPrefix != m_completer->completionPrefix()) {
         m_completer->setCompletionPrefix(completionPrefix);
         m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
@@ -570,7 +991,7 @@ void Page::insertCompletion(const QModelIndex &index)
     tc.insertText(completion.right(extra));
 
     QChar type = m_completer->completionModel()->data(index, Qt::UserRole + 1).toChar();
-    qDebug() << "completion type:" << type;
+    qkLog(Editor) << "completion type:" << type;
     switch(type.toLatin1())
     {
     case 'f':
@@ -636,10 +1057,15 @@ void Page::resizeEvent(QResizeEvent *e)
     QRect cr = contentsRect();
     lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
     foldsLine->setGeometry(QRect(lineNumberAreaWidth(),cr.top(), FoldsLineWidth, cr.height()));
+
+    if(m_searchActive)
+        m_searchTimer->start();
 }
 
 void Page::braceMatch()
 {
+    PerfCounters::Scope scope(PerfCounters::BraceMatch);
+    StallWatchdog::Phase phase("Page::braceMatch");
     const QString bracesBegin = "{(";
     const QString bracesEnd = "})";
 
@@ -662,7 +1088,8 @@ void Page::braceMatch()
     }
     if(n < 0)
     {
-        setExtraSelections(extraSelections);
+        m_braceSelections = extraSelections;
+        updateExtraSelections();
         return;
     }
 
@@ -720,12 +1147,13 @@ void Page::braceMatch()
 
     extraSelections.append(braceBeginSelection);
     extraSelections.append(braceEndSelection);
-    setExtraSelections(extraSelections);
+    m_braceSelections = extraSelections;
+    updateExtraSelections();
 }
 
 void Page::autoIndent()
 {
-    qDebug() << "autoIndent()";
+    qkLog(Editor) << "autoIndent()";
 
     QString esc = "\n\t ";
     QTextCursor tc = textCursor();
@@ -840,7 +1268,7 @@ void Page::slotTextChanged()
     QTextCursor cursor = textCursor();
     cursor.movePosition(QTextCursor::PreviousCharacter, QTextCursor::KeepAnchor);
     QString str = cursor.selectedText();
-    qDebug() << "str" << str;
+    qkLog(Editor) << "str" << str;
     //char c = str.at(0).toLatin1();
     //onChar(c);
 }
@@ -848,7 +1276,9 @@ void Page::slotTextChanged()
 void Page::slotCursorPositionChanged()
 {
     //qDebug() << "cursor pos" << textCursor().position();
-    setFunctionTooltip(!m_completer->popup()->isVisible());
+    // only follow the cursor while a call is being shown
+    if(m_codeTip->isVisible())
+        setFunctionTooltip(!m_completer->popup()->isVisible());
 }
 
 void Page::foldsLinePaintEvent(QPaintEvent *event)
@@ -885,6 +1315,7 @@ void Page::foldsLinePaintEvent(QPaintEvent *event)
 
 void Page::lineNumberAreaPaintEvent(QPaintEvent *event)
 {
+    PerfCounters::Scope scope(PerfCounters::GutterPaint);
     QPainter painter(lineNumberArea);
     painter.fillRect(event->rect(), QColor("#eee"));
 //    painter.fillRect(event->rect(), QColor("#111111"));
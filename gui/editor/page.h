@@ -22,16 +22,21 @@
 
 #include <QTextEdit>
 #include <QPlainTextEdit>
+#include <QRegExp>
+#include "preprocessor.h"
+#include "semanticindexer.h"
 
 class Highlighter;
 class Completer;
 class QAbstractItemModel;
+class QTimer;
 
 class QPaintEvent;
 class QResizeEvent;
 class QSize;
 class QWidget;
 class CodeTip;
+class OccurrenceIndex;
 
 class LineNumberArea;
 
@@ -39,12 +44,24 @@ class Page : public QPlainTextEdit
 {
     Q_OBJECT
 public:
+    enum FindFlag {
+        FindRegExp = 0x100
+    };
+
     explicit Page(const QString &name, QWidget *parent = 0);
 
     QString name();
     QString text();
+    void loadText(const QString &text);
+    void goToLine(int line, int column = 0);
+    static QRegExp findRegExp(const QString &text, int flags);
+    bool isLoading() { return m_loading; }
     Highlighter* highlighter() { return m_highligher; }
     Completer* completer() { return m_completer; }
+    void setOccurrenceIndex(OccurrenceIndex *index) { m_occurrenceIndex = index; }
+    void setPreprocessor(const Preprocessor &preprocessor);
+    void setSemanticIndexer(SemanticIndexer *indexer, const QString &filePath,
+                            const QStringList &arguments);
     
     void foldsLinePaintEvent(QPaintEvent *event);
     void lineNumberAreaPaintEvent(QPaintEvent *event);
@@ -62,10 +79,16 @@ signals:
     void keyPressed();
     void focused();
     void info(QString);
+    void loaded();
+    void edited(int position, int charsRemoved, QString text);
+    void definitionRequested(QString symbol);
+    void referencesRequested(QString symbol);
+    void callersRequested(QString symbol);
     
 public slots:
     void slotFind(const QString &text, int flags);
     void slotReplace(const QString &prev, const QString &current, int flags, bool all);
+    void slotHighlightMatches(const QString &text, int flags);
 
 private slots:
     void slotUpdateCodeBlocks();
@@ -79,10 +102,24 @@ private slots:
 
     void onChar(char c);
 
+    void slotLoadChunk();
+    void slotAttachHighlighter();
+    void slotHighlightChunk();
+    void slotContentsChange(int position, int charsRemoved, int charsAdded);
+    void updateSearchSelections();
+    void updateInactiveLines();
+    void requestSemanticTokens();
+    void slotSemanticIndexed(const QString &filePath, int revision,
+                             const QList<SemanticToken> &tokens);
+
     void braceMatch();
     void autoIndent();
 
 private:
+    static QString expandCaptures(const QString &replacement, const QRegExp &rx);
+    static QString wordUnderCursor(QTextCursor tc);
+    void updateExtraSelections();
+
     class CodeBlock {
     public:
         int startLine;
@@ -92,17 +129,52 @@ private:
     enum {
         FoldsLineWidth = 0
     };
+    enum {
+        LoadChunkSize = 64*1024,
+        LoadChunkThreshold = 256*1024,
+        HighlightChunkBlocks = 500
+    };
+    enum {
+        SearchUpdateDelay = 30,
+        PreprocessDelay = 300,
+        MaxCallLines = 20,
+        SemanticDelay = 500,
+        MaxSearchSelections = 2000
+    };
     Highlighter *m_highligher;
     Completer *m_completer;
     CodeTip *m_codeTip;
+    OccurrenceIndex *m_occurrenceIndex;
     QString m_name;
     int m_lastTextCursorPosition;
 
+    QString m_loadText;
+    int m_loadPos;
+    bool m_loading;
+    QTimer *m_highlightTimer;
+    bool m_trackEdits;
+    int m_revision;
+    int m_pendingLine;
+    int m_pendingColumn;
+
+    QRegExp m_searchRegExp;
+    bool m_searchActive;
+    QTimer *m_searchTimer;
+    QList<QTextEdit::ExtraSelection> m_searchSelections;
+    QList<QTextEdit::ExtraSelection> m_braceSelections;
+
+    Preprocessor m_preprocessor;
+    QTimer *m_preprocessTimer;
+
+    SemanticIndexer *m_semanticIndexer;
+    QString m_semanticPath;
+    QStringList m_semanticArguments;
+    QTimer *m_semanticTimer;
+
     QWidget *lineNumberArea;
     QWidget *foldsLine;
 
-    int functionArg(int cursorPos, QStringList args);
-    QStringList parseFunctionArgs(const QString &args);
+    bool findCall(QString *functionName, int *openPosition, int *argument);
     bool setFunctionTooltip(bool show = true);
     QTextLine currentTextLine(const QTextCursor &cursor);
     QString lineUnderCursor(const QTextCursor &cursor) const;
@@ -38,9 +38,18 @@ void PageTab::focusInEvent(QFocusEvent *)
 
 }
 
+QString PageTab::pageName(int index)
+{
+    Page *p = page(index);
+    if(p != 0)
+        return p->name();
+    return widget(index)->property("pageName").toString();
+}
+
 void PageTab::removeTab(int index)
 {
-    page(index)->close();
+    if(page(index) != 0)
+        page(index)->close();
     QTabWidget::removeTab(index);
 }
 
@@ -49,7 +58,8 @@ QList<Page *> PageTab::pages()
     QList<Page *> list;
     for(int i = 0; i < count(); i++)
     {
-        list.append(page(i));
+        if(page(i) != 0)
+            list.append(page(i));
     }
 
     return list;
@@ -57,13 +67,11 @@ QList<Page *> PageTab::pages()
 
 int PageTab::hasPage(const QString &pageName)
 {
-    int index = -1;
-    for(index = 0; index < count(); index++)
+    for(int index = 0; index < count(); index++)
     {
-        Page *page = qobject_cast<Page *>(widget(index));
-        if(page->name().compare(pageName) == 0)
+        if(this->pageName(index).compare(pageName) == 0)
             return index;
     }
 
-    return index;
+    return -1;
 }
@@ -32,6 +32,7 @@ public:
 
     Page* page(int index);
     QList<Page *> pages();
+    QString pageName(int index);
     int hasPage(const QString &pageName);
 
     void removeTab(int index);
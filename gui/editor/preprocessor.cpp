@@ -0,0 +1,514 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "preprocessor.h"
+#include "textfile.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <QRegExp>
+
+QHash<QString, Preprocessor::Defines> Preprocessor::m_targetCache;
+
+Preprocessor::Preprocessor() :
+    m_valid(false),
+    m_opaque(false)
+{
+}
+
+Preprocessor::Preprocessor(const Defines &defines, const QSet<QString> &external,
+                           const QSet<QString> &headers) :
+    m_defines(defines),
+    m_external(external),
+    m_headers(headers),
+    m_valid(true),
+    m_opaque(false)
+{
+}
+
+QVector<bool> Preprocessor::inactiveLines(const QString &text)
+{
+    QStringList lines = text.split('\n');
+    QVector<bool> inactive(lines.count(), false);
+
+    m_local = m_defines;
+    m_opaque = false;
+    QList<Frame> stack;
+    bool active = true;
+    bool inComment = false;
+
+    for(int i = 0; i < lines.count(); i++)
+    {
+        inactive[i] = !active;
+
+        // strip comments, keeping block comment state across lines
+        QString line;
+        const QString &raw = lines.at(i);
+        for(int c = 0; c < raw.size(); c++)
+        {
+            if(inComment)
+            {
+                if(raw.at(c) == '*' && c + 1 < raw.size() && raw.at(c+1) == '/')
+                {
+                    inComment = false;
+                    c++;
+                }
+            }
+            else if(raw.at(c) == '/' && c + 1 < raw.size() && raw.at(c+1) == '*')
+            {
+                inComment = true;
+                c++;
+            }
+            else if(raw.at(c) == '/' && c + 1 < raw.size() && raw.at(c+1) == '/')
+                break;
+            else
+                line.append(raw.at(c));
+        }
+
+        line = line.trimmed();
+        if(!line.startsWith('#'))
+            continue;
+
+        // join continuation lines
+        while(line.endsWith('\\') && i + 1 < lines.count())
+        {
+            line.chop(1);
+            i++;
+            inactive[i] = !active;
+            line += " " + lines.at(i).trimmed();
+        }
+
+        line = line.mid(1).trimmed();
+        int space = 0;
+        while(space < line.size() && (line.at(space).isLetter()))
+            space++;
+        QString directive = line.left(space);
+        QString argument = line.mid(space).trimmed();
+
+        if(directive == "if" || directive == "ifdef" || directive == "ifndef")
+        {
+            Value value;
+            if(directive == "if")
+                value = active ? evaluate(argument) : False;
+            else
+            {
+                QString name = argument.section(QRegExp("\\s"), 0, 0);
+                if(!isKnown(name))
+                    value = Unknown;
+                else
+                    value = (m_local.contains(name) == (directive == "ifdef")) ? True : False;
+            }
+
+            Frame frame;
+            frame.parentActive = active;
+            frame.active = active && value != False;
+            frame.taken = (value == True);
+            stack.append(frame);
+            active = frame.active;
+        }
+        else if(directive == "elif")
+        {
+            if(stack.isEmpty())
+                continue;
+            Frame &frame = stack.last();
+            inactive[i] = !frame.parentActive;
+            if(frame.taken || !frame.parentActive)
+                frame.active = false;
+            else
+            {
+                Value value = evaluate(argument);
+                frame.active = (value != False);
+                frame.taken = (value == True);
+            }
+            active = frame.active;
+        }
+        else if(directive == "else")
+        {
+            if(stack.isEmpty())
+                continue;
+            Frame &frame = stack.last();
+            inactive[i] = !frame.parentActive;
+            frame.active = frame.parentActive && !frame.taken;
+            frame.taken = true;
+            active = frame.active;
+        }
+        else if(directive == "endif")
+        {
+            if(stack.isEmpty())
+                continue;
+            inactive[i] = !stack.last().parentActive;
+            active = stack.takeLast().parentActive;
+        }
+        else if(active && directive == "define")
+        {
+            QRegExp rx("^([A-Za-z_]\\w*)(\\([^)]*\\))?\\s*(.*)$");
+            if(rx.indexIn(argument) != -1)
+                m_local.insert(rx.cap(1), rx.cap(2).isEmpty() ? rx.cap(3) : QString());
+        }
+        else if(active && directive == "undef")
+            m_local.remove(argument.section(QRegExp("\\s"), 0, 0));
+        else if(active && directive == "include")
+        {
+            QString header = argument.mid(1).section(QRegExp("[\">]"), 0, 0);
+            if(!m_headers.contains(header.section('/', -1)))
+                m_opaque = true;
+        }
+    }
+
+    return inactive;
+}
+
+QList<CodeParser::Element> Preprocessor::activeElements(const QList<CodeParser::Element> &tags)
+{
+    QHash<QString, QVector<bool> > files;
+    QSet<QString> seen;
+    QList<CodeParser::Element> lists[5];
+
+    foreach(const CodeParser::Element &tag, tags)
+    {
+        if(!files.contains(tag.fileName))
+        {
+            QString text;
+            if(TextFile::read(tag.fileName, &text))
+                files.insert(tag.fileName, inactiveLines(text));
+            else
+                files.insert(tag.fileName, QVector<bool>());
+        }
+        const QVector<bool> &inactive = files[tag.fileName];
+        if(tag.line > 0 && tag.line <= inactive.count() && inactive.at(tag.line - 1))
+            continue;
+
+        // same selection as CodeParser, the first active one of each name
+        int list;
+        switch(tag.type)
+        {
+        case CodeParser::Element::Function: list = 0; break;
+        case CodeParser::Element::Define:   list = 1; break;
+        case CodeParser::Element::Enum:     list = 2; break;
+        case CodeParser::Element::Typedef:  list = 3; break;
+        case CodeParser::Element::Variable: list = 4; break;
+        default:
+            continue;
+        }
+        if(tag.type == CodeParser::Element::Define && tag.text.endsWith("_H"))
+            continue;
+
+        QString key = QString::number(list) + tag.text;
+        if(seen.contains(key))
+            continue;
+        seen.insert(key);
+        lists[list].append(tag);
+    }
+
+    QList<CodeParser::Element> elements;
+    for(int i = 0; i < 5; i++)
+        elements.append(lists[i]);
+    return elements;
+}
+
+Preprocessor::Defines Preprocessor::targetDefines(const QString &embDir,
+                                                  const QString &targetName,
+                                                  const QString &targetVariant)
+{
+    QString name = targetName.toLower();
+    QString variant = targetVariant.toLower();
+    QString key = name + "." + variant;
+    if(m_targetCache.contains(key))
+        return m_targetCache.value(key);
+
+    // the same files the makefile template includes for the target
+    Defines defines;
+    readMakefile(embDir + "/target/" + name + "/" + name + ".mk", &defines);
+    readMakefile(embDir + "/target/" + name + "/board/" + variant + ".mk", &defines);
+    readMakefile(embDir + "/qkperipheral/build/target/" + name + "/board/" + variant + ".mk", &defines);
+    defines.insert("BUILD_DEVICE", QString());
+
+    m_targetCache.insert(key, defines);
+    return defines;
+}
+
+void Preprocessor::readMakefile(const QString &filePath, Defines *defines)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "can't open target makefile:" << filePath;
+        return;
+    }
+
+    QRegExp assignment("^([A-Za-z_]\\w*)\\s*(\\+=|:=|\\?=|=)\\s*(.*)$");
+    QTextStream in(&file);
+    while(!in.atEnd())
+    {
+        QString line = in.readLine().section('#', 0, 0).trimmed();
+        if(assignment.indexIn(line) == -1)
+            continue;
+
+        QString variable = assignment.cap(1);
+        QStringList words = assignment.cap(3).split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        foreach(QString word, words)
+        {
+            if(word.contains('$'))
+                continue;
+            if(variable == "CFLAGS" && word.startsWith("-D"))
+                word = word.mid(2);
+            else if(variable != "DEFINES")
+                continue;
+            defines->insert(word.section('=', 0, 0), word.section('=', 1));
+        }
+
+        // passed as -DINIT_CLKFREQ=$(INIT_CLKFREQ) by the makefile template
+        if(variable == "INIT_CLKFREQ" && !words.isEmpty())
+            defines->insert(variable, words.first());
+    }
+}
+
+Preprocessor::Value Preprocessor::evaluate(const QString &expression)
+{
+    m_tokens = tokenize(expression);
+    m_pos = 0;
+    m_unknown = false;
+    m_depth = 0;
+
+    qint64 value = parseConditional();
+    if(m_unknown || m_pos != m_tokens.count())
+        return Unknown;
+    return value != 0 ? True : False;
+}
+
+bool Preprocessor::isKnown(const QString &name)
+{
+    // compiler builtins and macros from other headers can't be decided here
+    if(m_local.contains(name))
+        return true;
+    if(name.startsWith("__") || (name.startsWith('_') && name.size() > 1 && name.at(1).isUpper()))
+        return false;
+    if(m_opaque)
+        return false;
+    return !m_external.contains(name);
+}
+
+qint64 Preprocessor::parseConditional()
+{
+    qint64 condition = parseBinary(0);
+    if(m_pos < m_tokens.count() && m_tokens.at(m_pos) == "?")
+    {
+        m_pos++;
+        qint64 a = parseConditional();
+        if(m_pos < m_tokens.count() && m_tokens.at(m_pos) == ":")
+            m_pos++;
+        else
+            m_unknown = true;
+        qint64 b = parseConditional();
+        return condition ? a : b;
+    }
+    return condition;
+}
+
+qint64 Preprocessor::parseBinary(int level)
+{
+    static const char *levels[][6] = {
+        { "||", 0 },
+        { "&&", 0 },
+        { "|", 0 },
+        { "^", 0 },
+        { "&", 0 },
+        { "==", "!=", 0 },
+        { "<", "<=", ">", ">=", 0 },
+        { "<<", ">>", 0 },
+        { "+", "-", 0 },
+        { "*", "/", "%", 0 }
+    };
+    const int levelCount = sizeof(levels) / sizeof(levels[0]);
+    if(level == levelCount)
+        return parseUnary();
+
+    qint64 left = parseBinary(level + 1);
+    while(m_pos < m_tokens.count())
+    {
+        QString op = m_tokens.at(m_pos);
+        bool found = false;
+        for(int i = 0; levels[level][i] != 0; i++)
+            if(op == levels[level][i])
+                found = true;
+        if(!found)
+            break;
+        m_pos++;
+
+        qint64 right = parseBinary(level + 1);
+        if(op == "||") left = left || right;
+        else if(op == "&&") left = left && right;
+        else if(op == "|") left = left | right;
+        else if(op == "^") left = left ^ right;
+        else if(op == "&") left = left & right;
+        else if(op == "==") left = left == right;
+        else if(op == "!=") left = left != right;
+        else if(op == "<") left = left < right;
+        else if(op == "<=") left = left <= right;
+        else if(op == ">") left = left > right;
+        else if(op == ">=") left = left >= right;
+        else if((op == "<<" || op == ">>") && (right < 0 || right > 62)) m_unknown = true;
+        else if(op == "<<") left = left << right;
+        else if(op == ">>") left = left >> right;
+        else if(op == "+") left = left + right;
+        else if(op == "-") left = left - right;
+        else if(op == "*") left = left * right;
+        else if(right == 0) m_unknown = true;
+        else if(op == "/") left = left / right;
+        else left = left % right;
+    }
+    return left;
+}
+
+qint64 Preprocessor::parseUnary()
+{
+    if(m_pos >= m_tokens.count())
+    {
+        m_unknown = true;
+        return 0;
+    }
+
+    QString token = m_tokens.at(m_pos);
+    if(token == "!") { m_pos++; return !parseUnary(); }
+    if(token == "~") { m_pos++; return ~parseUnary(); }
+    if(token == "-") { m_pos++; return -parseUnary(); }
+    if(token == "+") { m_pos++; return parseUnary(); }
+    return parsePrimary();
+}
+
+qint64 Preprocessor::parsePrimary()
+{
+    QString token = m_tokens.at(m_pos++);
+
+    if(token == "(")
+    {
+        qint64 value = parseConditional();
+        if(m_pos < m_tokens.count() && m_tokens.at(m_pos) == ")")
+            m_pos++;
+        else
+            m_unknown = true;
+        return value;
+    }
+
+    if(token == "defined")
+    {
+        bool parenthesis = (m_pos < m_tokens.count() && m_tokens.at(m_pos) == "(");
+        if(parenthesis)
+            m_pos++;
+        if(m_pos >= m_tokens.count())
+        {
+            m_unknown = true;
+            return 0;
+        }
+        QString name = m_tokens.at(m_pos++);
+        if(parenthesis && m_pos < m_tokens.count() && m_tokens.at(m_pos) == ")")
+            m_pos++;
+        if(!isKnown(name))
+            m_unknown = true;
+        return m_local.contains(name) ? 1 : 0;
+    }
+
+    if(token.at(0).isDigit())
+    {
+        QString number = token;
+        number.remove(QRegExp("[uUlL]+$"));
+        bool ok;
+        qint64 value = number.toLongLong(&ok, 0);
+        if(!ok)
+            m_unknown = true;
+        return value;
+    }
+
+    if(token.at(0).isLetter() || token.at(0) == '_')
+    {
+        // function-like macro calls are not expanded
+        if(m_pos < m_tokens.count() && m_tokens.at(m_pos) == "(")
+        {
+            m_unknown = true;
+            int depth = 0;
+            while(m_pos < m_tokens.count())
+            {
+                QString t = m_tokens.at(m_pos++);
+                if(t == "(") depth++;
+                else if(t == ")" && --depth == 0) break;
+            }
+            return 0;
+        }
+        return macroValue(token);
+    }
+
+    m_unknown = true;
+    return 0;
+}
+
+qint64 Preprocessor::macroValue(const QString &name)
+{
+    if(!isKnown(name))
+    {
+        m_unknown = true;
+        return 0;
+    }
+    if(!m_local.contains(name))
+        return 0;
+    if(m_depth >= MaxExpansionDepth)
+    {
+        m_unknown = true;
+        return 0;
+    }
+
+    QStringList tokens = m_tokens;
+    int pos = m_pos;
+    m_tokens = tokenize(m_local.value(name));
+    m_pos = 0;
+    m_depth++;
+
+    qint64 value = 0;
+    if(m_tokens.isEmpty())
+        m_unknown = true;
+    else
+        value = parseConditional();
+    if(m_pos != m_tokens.count())
+        m_unknown = true;
+
+    m_depth--;
+    m_tokens = tokens;
+    m_pos = pos;
+    return value;
+}
+
+QStringList Preprocessor::tokenize(const QString &expression)
+{
+    static QRegExp rx("([A-Za-z_]\\w*|0[xX][0-9a-fA-F]+\\w*|\\d+\\w*|"
+                      "\\|\\||&&|==|!=|<=|>=|<<|>>|[-+*/%<>&|^!~?:()])");
+    QStringList tokens;
+    int pos = 0;
+    int next;
+    while((next = rx.indexIn(expression, pos)) != -1)
+    {
+        // anything else (character literals, casts...) can't be evaluated
+        if(!expression.mid(pos, next - pos).trimmed().isEmpty())
+            tokens.append("#");
+        tokens.append(rx.cap(1));
+        pos = next + rx.matchedLength();
+    }
+    if(!expression.mid(pos).trimmed().isEmpty())
+        tokens.append("#");
+    return tokens;
+}
@@ -0,0 +1,100 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PREPROCESSOR_H
+#define PREPROCESSOR_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QStringList>
+#include "codeparser.h"
+
+/*
+ * Evaluates #if/#ifdef/#elif/#else/#endif against a build target's defines
+ * to find the lines the compiler would skip. Macros that may come from an
+ * included header or from the compiler itself are taken as unknown, and a
+ * branch is only reported inactive when that is certain. Once a file
+ * includes a header that is not in the known set (a toolchain header, for
+ * one) no macro is assumed undefined past that line.
+ */
+class Preprocessor
+{
+public:
+    typedef QHash<QString, QString> Defines;
+
+    Preprocessor();
+    Preprocessor(const Defines &defines, const QSet<QString> &external,
+                 const QSet<QString> &headers = QSet<QString>());
+
+    bool isValid() { return m_valid; }
+    QVector<bool> inactiveLines(const QString &text);
+    QList<CodeParser::Element> activeElements(const QList<CodeParser::Element> &tags);
+
+    static Defines targetDefines(const QString &embDir,
+                                 const QString &targetName, const QString &targetVariant);
+
+private:
+    enum Value
+    {
+        False = 0,
+        True,
+        Unknown
+    };
+    enum
+    {
+        MaxExpansionDepth = 8
+    };
+
+    class Frame
+    {
+    public:
+        bool parentActive;
+        bool active;
+        bool taken;
+    };
+
+    Defines m_defines;
+    QSet<QString> m_external;
+    QSet<QString> m_headers;
+    bool m_valid;
+    bool m_opaque;
+
+    // state of the expression being evaluated
+    Defines m_local;
+    QStringList m_tokens;
+    int m_pos;
+    bool m_unknown;
+    int m_depth;
+
+    Value evaluate(const QString &expression);
+    qint64 parseConditional();
+    qint64 parseBinary(int level);
+    qint64 parseUnary();
+    qint64 parsePrimary();
+    qint64 macroValue(const QString &name);
+    bool isKnown(const QString &name);
+
+    static QStringList tokenize(const QString &expression);
+    static void readMakefile(const QString &filePath, Defines *defines);
+
+    static QHash<QString, Defines> m_targetCache;
+};
+
+#endif // PREPROCESSOR_H
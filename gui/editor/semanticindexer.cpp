@@ -0,0 +1,327 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "semanticindexer.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QVector>
+
+#ifdef QKIDE_LIBCLANG
+#include <clang-c/Index.h>
+
+static int tokenKind(CXCursor cursor)
+{
+    if(cursor.kind == CXCursor_MacroExpansion || cursor.kind == CXCursor_MacroDefinition)
+        return SemanticToken::Macro;
+
+    CXCursor referenced = clang_getCursorReferenced(cursor);
+    if(clang_Cursor_isNull(referenced))
+        return -1;
+
+    switch(clang_getCursorKind(referenced))
+    {
+    case CXCursor_ParmDecl:
+        return SemanticToken::Parameter;
+    case CXCursor_VarDecl:
+        if(clang_getCursorKind(clang_getCursorSemanticParent(referenced)) == CXCursor_FunctionDecl)
+            return SemanticToken::LocalVariable;
+        return -1;
+    case CXCursor_FieldDecl:
+        return SemanticToken::Field;
+    case CXCursor_EnumConstantDecl:
+        return SemanticToken::Enumerator;
+    case CXCursor_TypedefDecl:
+    case CXCursor_StructDecl:
+    case CXCursor_UnionDecl:
+    case CXCursor_EnumDecl:
+        return SemanticToken::Type;
+    case CXCursor_MacroDefinition:
+        return SemanticToken::Macro;
+    default:
+        return -1;
+    }
+}
+#endif
+
+SemanticIndexer::SemanticIndexer(const QString &cacheDir, QObject *parent) :
+    QObject(parent),
+    m_busy(false),
+    m_cacheDir(cacheDir),
+    m_index(0)
+{
+    qRegisterMetaType<SemanticToken>("SemanticToken");
+    qRegisterMetaType<QList<SemanticToken> >("QList<SemanticToken>");
+    QDir().mkpath(m_cacheDir);
+}
+
+SemanticIndexer::~SemanticIndexer()
+{
+#ifdef QKIDE_LIBCLANG
+    foreach(void *unit, m_units)
+        clang_disposeTranslationUnit((CXTranslationUnit) unit);
+    if(m_index != 0)
+        clang_disposeIndex((CXIndex) m_index);
+#endif
+}
+
+bool SemanticIndexer::isAvailable()
+{
+#ifdef QKIDE_LIBCLANG
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SemanticIndexer::index(const QString &filePath, const QString &text,
+                            const QStringList &arguments, int revision)
+{
+    if(!isAvailable())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    if(!m_pending.contains(filePath))
+        m_queue.append(filePath);
+
+    Request request;
+    request.text = text;
+    request.arguments = arguments;
+    request.revision = revision;
+    m_pending.insert(filePath, request);
+
+    if(!m_busy)
+    {
+        m_busy = true;
+        QMetaObject::invokeMethod(this, "slotProcess", Qt::QueuedConnection);
+    }
+}
+
+void SemanticIndexer::slotProcess()
+{
+    forever
+    {
+        m_mutex.lock();
+        if(m_queue.isEmpty())
+        {
+            m_busy = false;
+            m_mutex.unlock();
+            return;
+        }
+        QString filePath = m_queue.takeFirst();
+        Request request = m_pending.take(filePath);
+        m_mutex.unlock();
+
+        // the disk file is named after the file and arguments only, so a
+        // file being edited overwrites its entry instead of adding one
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(filePath.toUtf8());
+        hash.addData(request.arguments.join("\n").toUtf8());
+        QByteArray fileKey = hash.result().toHex();
+        QByteArray content = QCryptographicHash::hash(request.text.toUtf8(),
+                                                      QCryptographicHash::Sha1);
+        QByteArray key = fileKey + content.toHex();
+
+        QList<SemanticToken> tokens;
+        if(m_cache.contains(key))
+            tokens = m_cache.value(key);
+        else if(!readCache(fileKey, content, &tokens))
+        {
+            tokens = parse(filePath, request.text, request.arguments);
+            writeCache(fileKey, content, tokens);
+        }
+
+        if(!m_cache.contains(key) && m_cache.count() >= MaxCachedFiles)
+            m_cache.remove(m_cacheOrder.takeFirst());
+        m_cache.insert(key, tokens);
+        m_cacheOrder.removeOne(key);
+        m_cacheOrder.append(key);
+
+        emit indexed(filePath, request.revision, tokens);
+    }
+}
+
+QList<SemanticToken> SemanticIndexer::parse(const QString &filePath, const QString &text,
+                                            const QStringList &arguments)
+{
+    QList<SemanticToken> tokens;
+
+#ifdef QKIDE_LIBCLANG
+    if(m_index == 0)
+        m_index = clang_createIndex(0, 0);
+
+    QByteArray path = filePath.toUtf8();
+    QByteArray contents = text.toUtf8();
+    CXUnsavedFile unsaved;
+    unsaved.Filename = path.constData();
+    unsaved.Contents = contents.constData();
+    unsaved.Length = contents.size();
+
+    // reparsing a kept unit only redoes the main file, headers are reused
+    CXTranslationUnit unit = (CXTranslationUnit) m_units.value(filePath, 0);
+    if(unit != 0 && m_unitArguments.value(filePath) == arguments)
+    {
+        if(clang_reparseTranslationUnit(unit, 1, &unsaved, clang_defaultReparseOptions(unit)) != 0)
+        {
+            clang_disposeTranslationUnit(unit);
+            m_units.remove(filePath);
+            m_unitOrder.removeOne(filePath);
+            unit = 0;
+        }
+    }
+    else if(unit != 0)
+    {
+        clang_disposeTranslationUnit(unit);
+        m_units.remove(filePath);
+        m_unitOrder.removeOne(filePath);
+        unit = 0;
+    }
+
+    if(unit == 0)
+    {
+        QList<QByteArray> args;
+        QVector<const char*> argv;
+        foreach(QString argument, arguments)
+            args.append(argument.toUtf8());
+        foreach(const QByteArray &arg, args)
+            argv.append(arg.constData());
+
+        unit = clang_parseTranslationUnit((CXIndex) m_index, path.constData(),
+                                          argv.data(), argv.count(), &unsaved, 1,
+                                          clang_defaultEditingTranslationUnitOptions() |
+                                          CXTranslationUnit_DetailedPreprocessingRecord);
+        if(unit == 0)
+        {
+            qDebug() << "clang failed to parse" << filePath;
+            return tokens;
+        }
+
+        // the least recently used unit goes
+        if(m_units.count() >= MaxUnits)
+        {
+            QString evicted = m_unitOrder.takeFirst();
+            clang_disposeTranslationUnit((CXTranslationUnit) m_units.take(evicted));
+            m_unitArguments.remove(evicted);
+        }
+        m_units.insert(filePath, unit);
+        m_unitArguments.insert(filePath, arguments);
+    }
+    m_unitOrder.removeOne(filePath);
+    m_unitOrder.append(filePath);
+
+    CXFile file = clang_getFile(unit, path.constData());
+    CXSourceRange range = clang_getRange(clang_getLocationForOffset(unit, file, 0),
+                                         clang_getLocationForOffset(unit, file, contents.size()));
+    CXToken *cxTokens = 0;
+    unsigned count = 0;
+    clang_tokenize(unit, range, &cxTokens, &count);
+    QVector<CXCursor> cursors(count);
+    clang_annotateTokens(unit, cxTokens, count, cursors.data());
+
+    // clang columns count bytes, the editor counts characters
+    QStringList lines = text.split('\n');
+
+    for(unsigned i = 0; i < count; i++)
+    {
+        if(clang_getTokenKind(cxTokens[i]) != CXToken_Identifier)
+            continue;
+        int kind = tokenKind(cursors[i]);
+        if(kind == -1)
+            continue;
+
+        unsigned line, column;
+        clang_getSpellingLocation(clang_getTokenLocation(unit, cxTokens[i]), 0, &line, &column, 0);
+        CXString spelling = clang_getTokenSpelling(unit, cxTokens[i]);
+        QString name = QString::fromUtf8(clang_getCString(spelling));
+        clang_disposeString(spelling);
+
+        QString lineText = lines.value(line - 1);
+        SemanticToken token;
+        token.line = line;
+        token.column = QString::fromUtf8(lineText.toUtf8().left(column - 1)).length();
+        token.length = name.length();
+        token.kind = kind;
+        tokens.append(token);
+    }
+
+    clang_disposeTokens(unit, cxTokens, count);
+#else
+    Q_UNUSED(filePath);
+    Q_UNUSED(text);
+    Q_UNUSED(arguments);
+#endif
+
+    return tokens;
+}
+
+bool SemanticIndexer::readCache(const QByteArray &key, const QByteArray &content,
+                                QList<SemanticToken> *tokens)
+{
+    QFile file(m_cacheDir + "/" + key + ".tok");
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint8 version;
+    QByteArray storedContent;
+    qint32 count;
+    in >> version;
+    if(version != CacheVersion)
+        return false;
+    in >> storedContent >> count;
+    if(storedContent != content)
+        return false;
+
+    tokens->clear();
+    for(int i = 0; i < count && in.status() == QDataStream::Ok; i++)
+    {
+        qint32 line, column, length, kind;
+        in >> line >> column >> length >> kind;
+        SemanticToken token;
+        token.line = line;
+        token.column = column;
+        token.length = length;
+        token.kind = kind;
+        tokens->append(token);
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+void SemanticIndexer::writeCache(const QByteArray &key, const QByteArray &content,
+                                 const QList<SemanticToken> &tokens)
+{
+    QSaveFile file(m_cacheDir + "/" + key + ".tok");
+    if(!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << (quint8) CacheVersion << content << (qint32) tokens.count();
+    foreach(const SemanticToken &token, tokens)
+        out << (qint32) token.line << (qint32) token.column
+            << (qint32) token.length << (qint32) token.kind;
+    file.commit();
+}
@@ -0,0 +1,120 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEMANTICINDEXER_H
+#define SEMANTICINDEXER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QMetaType>
+#include <QMutex>
+
+class SemanticToken
+{
+public:
+    enum Kind
+    {
+        LocalVariable = 0,
+        Parameter,
+        Macro,
+        Field,
+        Enumerator,
+        Type,
+        KindCount
+    };
+    int line;
+    int column;
+    int length;
+    int kind;
+
+    bool operator==(const SemanticToken &other) const
+    {
+        return line == other.line && column == other.column &&
+               length == other.length && kind == other.kind;
+    }
+};
+
+Q_DECLARE_METATYPE(SemanticToken)
+Q_DECLARE_METATYPE(QList<SemanticToken>)
+
+/*
+ * Finds what each identifier of a file refers to (local, parameter, macro,
+ * struct member...) with libclang, from a worker thread. Only built with
+ * CONFIG += libclang, otherwise isAvailable() is false and requests are
+ * ignored. Results are cached by file content and compiler arguments, in
+ * memory and under the temp folder, where each file and argument set keeps
+ * only its latest result.
+ */
+class SemanticIndexer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SemanticIndexer(const QString &cacheDir, QObject *parent = 0);
+    ~SemanticIndexer();
+
+    static bool isAvailable();
+    void index(const QString &filePath, const QString &text,
+               const QStringList &arguments, int revision);
+
+signals:
+    void indexed(QString filePath, int revision, QList<SemanticToken> tokens);
+
+private slots:
+    void slotProcess();
+
+private:
+    enum
+    {
+        MaxUnits = 8,
+        MaxCachedFiles = 64,
+        CacheVersion = 2
+    };
+    class Request
+    {
+    public:
+        QString text;
+        QStringList arguments;
+        int revision;
+    };
+
+    QMutex m_mutex;
+    QHash<QString, Request> m_pending;
+    QStringList m_queue;
+    bool m_busy;
+
+    QString m_cacheDir;
+    QHash<QByteArray, QList<SemanticToken> > m_cache;
+    QList<QByteArray> m_cacheOrder;
+
+    void *m_index;
+    QHash<QString, void*> m_units;
+    QStringList m_unitOrder;
+    QHash<QString, QStringList> m_unitArguments;
+
+    QList<SemanticToken> parse(const QString &filePath, const QString &text,
+                               const QStringList &arguments);
+    bool readCache(const QByteArray &key, const QByteArray &content,
+                   QList<SemanticToken> *tokens);
+    void writeCache(const QByteArray &key, const QByteArray &content,
+                    const QList<SemanticToken> &tokens);
+};
+
+#endif // SEMANTICINDEXER_H
@@ -0,0 +1,75 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "symbolindex.h"
+
+#include <QDir>
+
+SymbolIndex::SymbolIndex()
+{
+}
+
+void SymbolIndex::setLibrary(const QList<CodeParser::Element> &tags)
+{
+    m_library.clear();
+    foreach(const CodeParser::Element &tag, tags)
+        insert(&m_library, tag, QDir::cleanPath(tag.fileName));
+}
+
+void SymbolIndex::setProject(const QList<CodeParser::Element> &tags,
+                             const QString &tagsPath, const QString &projectPath)
+{
+    QString from = QDir::cleanPath(tagsPath) + "/";
+    QString to = QDir::cleanPath(projectPath) + "/";
+
+    m_project.clear();
+    foreach(const CodeParser::Element &tag, tags)
+    {
+        QString filePath = QDir::cleanPath(tag.fileName);
+        if(filePath.startsWith(from))
+            filePath = to + filePath.mid(from.size());
+        insert(&m_project, tag, filePath);
+    }
+}
+
+QList<SymbolIndex::Location> SymbolIndex::definitions(const QString &symbol)
+{
+    // project first, and within each definitions before declarations
+    QList<Location> locations = m_project.value(symbol);
+    locations.append(m_library.value(symbol));
+
+    QList<Location> result;
+    foreach(const Location &location, locations)
+        if(!location.declaration)
+            result.append(location);
+    foreach(const Location &location, locations)
+        if(location.declaration)
+            result.append(location);
+    return result;
+}
+
+void SymbolIndex::insert(QHash<QString, QList<Location> > *hash,
+                         const CodeParser::Element &tag, const QString &filePath)
+{
+    Location location;
+    location.filePath = filePath;
+    location.line = tag.line;
+    location.declaration = tag.declaration;
+    (*hash)[tag.text].append(location);
+}
@@ -0,0 +1,60 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYMBOLINDEX_H
+#define SYMBOLINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "codeparser.h"
+
+/*
+ * Maps symbol names to the places they are defined, built from the ctags
+ * output of CodeParser. Project tags are parsed from copies of the pages,
+ * so their paths are mapped back to the project folder.
+ */
+class SymbolIndex
+{
+public:
+    class Location
+    {
+    public:
+        QString filePath;
+        int line;
+        bool declaration;
+    };
+
+    SymbolIndex();
+
+    void setLibrary(const QList<CodeParser::Element> &tags);
+    void setProject(const QList<CodeParser::Element> &tags,
+                    const QString &tagsPath, const QString &projectPath);
+
+    QList<Location> definitions(const QString &symbol);
+
+private:
+    QHash<QString, QList<Location> > m_library;
+    QHash<QString, QList<Location> > m_project;
+
+    static void insert(QHash<QString, QList<Location> > *hash,
+                       const CodeParser::Element &tag, const QString &filePath);
+};
+
+#endif // SYMBOLINDEX_H
@@ -0,0 +1,95 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "syntaxdefinition.h"
+#include "applog.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <QCoreApplication>
+
+SyntaxDefinition::SyntaxDefinition(QObject *parent) :
+    QObject(parent)
+{
+}
+
+SyntaxDefinition* SyntaxDefinition::instance()
+{
+    static SyntaxDefinition *definition = 0;
+    if(definition == 0)
+        definition = new SyntaxDefinition(qApp);
+    return definition;
+}
+
+bool SyntaxDefinition::load(const QString &filePath)
+{
+    if(filePath == m_filePath)
+        return true;
+
+    QFile file(filePath);
+    qkLog(Editor) << __FUNCTION__ << file.fileName();
+
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "failed to open syntax file:" << file.fileName();
+        return false;
+    }
+
+    // "#rule,name,color,weight" followed by one pattern per line up to
+    // "stop", a rule without patterns only gives a color to the name
+    QVector<Rule> rules;
+    QTextStream input(&file);
+    while(!input.atEnd())
+    {
+        QString header = input.readLine();
+        if(!header.contains("#rule"))
+            continue;
+
+        Rule rule;
+        rule.elementName = header.section(',', 1, 1);
+        rule.format.setForeground(QBrush(QColor(header.section(',', 2, 2))));
+        if(header.section(',', 3, 3).toLower() == "bold")
+            rule.format.setFontWeight(QFont::Bold);
+        else
+            rule.format.setFontWeight(QFont::Normal);
+
+        bool hasPattern = false;
+        while(!input.atEnd())
+        {
+            QString pattern = input.readLine();
+            if(pattern == "stop")
+                break;
+            rule.pattern = QRegExp(pattern);
+            rules.append(rule);
+            hasPattern = true;
+        }
+
+        if(!hasPattern)
+        {
+            rule.pattern = QRegExp();
+            rules.append(rule);
+        }
+    }
+
+    m_filePath = filePath;
+    m_rules = rules;
+    emit changed();
+    return true;
+}
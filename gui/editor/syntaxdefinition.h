@@ -0,0 +1,63 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYNTAXDEFINITION_H
+#define SYNTAXDEFINITION_H
+
+#include <QObject>
+#include <QVector>
+#include <QRegExp>
+#include <QTextCharFormat>
+
+/*
+ * The rules of a .syntax file, parsed once and shared by every Highlighter.
+ * Highlighters keep a copy of rules(), which is implicitly shared, and are
+ * told through changed() when another file is loaded.
+ */
+class SyntaxDefinition : public QObject
+{
+    Q_OBJECT
+public:
+    class Rule
+    {
+    public:
+        QString elementName;
+        QRegExp pattern;
+        QTextCharFormat format;
+    };
+
+    static SyntaxDefinition* instance();
+
+    bool load(const QString &filePath);
+    bool isLoaded() { return !m_filePath.isEmpty(); }
+    QString filePath() { return m_filePath; }
+
+    QVector<Rule> rules() { return m_rules; }
+
+signals:
+    void changed();
+
+private:
+    explicit SyntaxDefinition(QObject *parent = 0);
+
+    QString m_filePath;
+    QVector<Rule> m_rules;
+};
+
+#endif // SYNTAXDEFINITION_H
@@ -0,0 +1,169 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dataloggerwidget.h"
+#include "pplotwidget.h"
+#include "qkide_global.h"
+
+#include <QApplication>
+#include <QComboBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QThread>
+#include <QTimer>
+#include <QDateTime>
+#include <QDir>
+
+DataLoggerWidget::DataLoggerWidget(QWidget *parent) :
+    QWidget(parent),
+    m_buffer(65536),
+    m_capturing(false)
+{
+    m_captureThread = new QThread(this);
+    m_capture = new SerialCapture(&m_buffer);
+    m_capture->moveToThread(m_captureThread);
+    connect(this, SIGNAL(startCapture(QString,int,QString)),
+            m_capture, SLOT(start(QString,int,QString)));
+    connect(this, SIGNAL(stopCapture()), m_capture, SLOT(stop()));
+    connect(m_capture, SIGNAL(started(QString)), this, SLOT(slotStarted(QString)));
+    connect(m_capture, SIGNAL(stopped()), this, SLOT(slotStopped()));
+    connect(m_capture, SIGNAL(error(QString)), this, SLOT(slotError(QString)));
+    m_captureThread->start(QThread::HighPriority);
+
+    m_drainTimer = new QTimer(this);
+    m_drainTimer->setInterval(20);
+    connect(m_drainTimer, SIGNAL(timeout()), this, SLOT(slotDrain()));
+
+    m_plot = new pPlotWidget(this);
+    m_plot->setHistorySize(20000);
+
+    m_comboPort = new QComboBox(this);
+    m_comboBaud = new QComboBox(this);
+    m_comboBaud->addItems(QStringList() << "9600" << "38400" << "57600"
+                                        << "115200" << "230400" << "460800"
+                                        << "921600");
+    m_comboBaud->setCurrentText("115200");
+
+    m_buttonStart = new QPushButton(tr("Record"), this);
+    m_buttonStop = new QPushButton(tr("Stop"), this);
+    connect(m_buttonStart, SIGNAL(clicked()), this, SLOT(slotStart()));
+    connect(m_buttonStop, SIGNAL(clicked()), this, SLOT(slotStop()));
+
+    m_labelStatus = new QLabel(this);
+    m_labelStatus->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    QHBoxLayout *controlsLayout = new QHBoxLayout;
+    controlsLayout->addWidget(m_comboPort);
+    controlsLayout->addWidget(m_comboBaud);
+    controlsLayout->addWidget(m_buttonStart);
+    controlsLayout->addWidget(m_buttonStop);
+    controlsLayout->addWidget(m_labelStatus, 1);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setMargin(2);
+    mainLayout->addLayout(controlsLayout);
+    mainLayout->addWidget(m_plot, 1);
+    setLayout(mainLayout);
+
+    updateInterface();
+}
+
+DataLoggerWidget::~DataLoggerWidget()
+{
+    m_captureThread->quit();
+    m_captureThread->wait();
+    delete m_capture;
+}
+
+void DataLoggerWidget::setPorts(const QStringList &portNames)
+{
+    QString current = m_comboPort->currentText();
+    m_comboPort->clear();
+    m_comboPort->addItems(portNames);
+    if(portNames.contains(current))
+        m_comboPort->setCurrentText(current);
+    updateInterface();
+}
+
+void DataLoggerWidget::slotStart()
+{
+    if(m_capturing || m_comboPort->currentText().isEmpty())
+        return;
+
+    QString portName = m_comboPort->currentText();
+    QString logPath = QApplication::applicationDirPath() + TEMP_DIR + "/capture_" +
+                      QDateTime::currentDateTime().toString("yyMMddhhmmss") + ".qklog";
+
+    emit aboutToCapture(portName);
+
+    m_plot->clear();
+    m_buffer.clear();
+    m_capturing = true;
+    m_labelStatus->setText(tr("Opening %1...").arg(portName));
+    updateInterface();
+
+    emit startCapture(portName, m_comboBaud->currentText().toInt(), logPath);
+}
+
+void DataLoggerWidget::slotStop()
+{
+    emit stopCapture();
+}
+
+void DataLoggerWidget::slotStarted(const QString &logFileName)
+{
+    m_labelStatus->setText(QDir::toNativeSeparators(logFileName));
+    m_drainTimer->start();
+}
+
+void DataLoggerWidget::slotStopped()
+{
+    m_drainTimer->stop();
+    slotDrain();
+    m_capturing = false;
+    m_labelStatus->setText(tr("%1 samples recorded, %2 not plotted")
+                           .arg(m_capture->sampleCount())
+                           .arg(m_capture->droppedCount()));
+    updateInterface();
+}
+
+void DataLoggerWidget::slotError(const QString &message)
+{
+    m_drainTimer->stop();
+    m_capturing = false;
+    m_labelStatus->setText(message);
+    updateInterface();
+}
+
+void DataLoggerWidget::slotDrain()
+{
+    SerialCapture::Sample sample;
+    while(m_buffer.pop(&sample))
+        m_plot->addSample(sample.time, sample.values, sample.count);
+}
+
+void DataLoggerWidget::updateInterface()
+{
+    m_buttonStart->setEnabled(!m_capturing && m_comboPort->count() > 0);
+    m_buttonStop->setEnabled(m_capturing);
+    m_comboPort->setEnabled(!m_capturing);
+    m_comboBaud->setEnabled(!m_capturing);
+}
@@ -0,0 +1,75 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATALOGGERWIDGET_H
+#define DATALOGGERWIDGET_H
+
+#include <QWidget>
+#include "serialcapture.h"
+
+class pPlotWidget;
+class QComboBox;
+class QPushButton;
+class QLabel;
+class QThread;
+class QTimer;
+
+class DataLoggerWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit DataLoggerWidget(QWidget *parent = 0);
+    ~DataLoggerWidget();
+
+    void setPorts(const QStringList &portNames);
+    bool isCapturing() { return m_capturing; }
+
+signals:
+    void aboutToCapture(QString portName);
+    void startCapture(QString portName, int baudRate, QString logPath);
+    void stopCapture();
+
+public slots:
+    void slotStart();
+    void slotStop();
+
+private slots:
+    void slotStarted(const QString &logFileName);
+    void slotStopped();
+    void slotError(const QString &message);
+    void slotDrain();
+
+private:
+    RingBuffer<SerialCapture::Sample> m_buffer;
+    SerialCapture *m_capture;
+    QThread *m_captureThread;
+    QTimer *m_drainTimer;
+    bool m_capturing;
+
+    pPlotWidget *m_plot;
+    QComboBox *m_comboPort;
+    QComboBox *m_comboBaud;
+    QPushButton *m_buttonStart;
+    QPushButton *m_buttonStop;
+    QLabel *m_labelStatus;
+
+    void updateInterface();
+};
+
+#endif // DATALOGGERWIDGET_H
@@ -0,0 +1,119 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logviewerwidget.h"
+#include "applog.h"
+
+#include <QPlainTextEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QScrollBar>
+#include <QStringList>
+#include <QTimer>
+
+LogViewerWidget::LogViewerWidget(QWidget *parent) :
+    QWidget(parent),
+    m_serial(0)
+{
+    QHBoxLayout *controlsLayout = new QHBoxLayout;
+    for(int c = 0; c < AppLog::CategoryCount; c++)
+    {
+        QCheckBox *check = new QCheckBox(AppLog::name((AppLog::Category)c), this);
+        connect(check, SIGNAL(toggled(bool)), this, SLOT(slotCategoryToggled()));
+        controlsLayout->addWidget(check);
+        m_checkCategories.append(check);
+    }
+    controlsLayout->addStretch(1);
+
+    m_text = new QPlainTextEdit(this);
+    m_text->setReadOnly(true);
+    m_text->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_text->setMaximumBlockCount(MaxLines);
+
+    QPushButton *buttonClear = new QPushButton(tr("Clear"), this);
+    connect(buttonClear, SIGNAL(clicked()), m_text, SLOT(clear()));
+    controlsLayout->addWidget(buttonClear);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(RefreshInterval);
+    connect(m_refreshTimer, SIGNAL(timeout()), this, SLOT(slotRefresh()));
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setMargin(2);
+    mainLayout->addLayout(controlsLayout);
+    mainLayout->addWidget(m_text, 1);
+    setLayout(mainLayout);
+
+    updateCategories();
+}
+
+void LogViewerWidget::updateCategories()
+{
+    for(int c = 0; c < m_checkCategories.count(); c++)
+    {
+        QCheckBox *check = m_checkCategories[c];
+        check->blockSignals(true);
+        check->setChecked(AppLog::isEnabled((AppLog::Category)c));
+        check->blockSignals(false);
+    }
+}
+
+void LogViewerWidget::showEvent(QShowEvent *e)
+{
+    QWidget::showEvent(e);
+    updateCategories();
+    m_refreshTimer->start();
+    slotRefresh();
+}
+
+void LogViewerWidget::hideEvent(QHideEvent *e)
+{
+    QWidget::hideEvent(e);
+    m_refreshTimer->stop();
+}
+
+void LogViewerWidget::slotRefresh()
+{
+    QList<AppLog::Entry> entries = AppLog::entries(&m_serial);
+    if(entries.isEmpty())
+        return;
+
+    QScrollBar *scrollBar = m_text->verticalScrollBar();
+    bool atBottom = (scrollBar->value() == scrollBar->maximum());
+
+    QStringList lines;
+    foreach(const AppLog::Entry &entry, entries)
+    {
+        lines.append(entry.time.toString("hh:mm:ss.zzz") + " " +
+                     QString(AppLog::name(entry.category)).leftJustified(8) +
+                     entry.text);
+    }
+    m_text->appendPlainText(lines.join("\n"));
+
+    if(atBottom)
+        scrollBar->setValue(scrollBar->maximum());
+}
+
+void LogViewerWidget::slotCategoryToggled()
+{
+    for(int c = 0; c < m_checkCategories.count(); c++)
+        AppLog::setEnabled((AppLog::Category)c, m_checkCategories[c]->isChecked());
+}
@@ -0,0 +1,59 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOGVIEWERWIDGET_H
+#define LOGVIEWERWIDGET_H
+
+#include <QWidget>
+#include <QList>
+
+class QPlainTextEdit;
+class QCheckBox;
+class QTimer;
+
+class LogViewerWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LogViewerWidget(QWidget *parent = 0);
+
+    void updateCategories();
+
+protected:
+    void showEvent(QShowEvent *e);
+    void hideEvent(QHideEvent *e);
+
+private slots:
+    void slotRefresh();
+    void slotCategoryToggled();
+
+private:
+    enum
+    {
+        RefreshInterval = 250,
+        MaxLines = 2000
+    };
+
+    QPlainTextEdit *m_text;
+    QList<QCheckBox*> m_checkCategories;
+    QTimer *m_refreshTimer;
+    int m_serial;
+};
+
+#endif // LOGVIEWERWIDGET_H
@@ -0,0 +1,122 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "perfhudwidget.h"
+#include "perfcounters.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QTimer>
+
+PerfHudWidget::PerfHudWidget(QWidget *parent) :
+    QWidget(parent)
+{
+    m_table = new QTableWidget(PerfCounters::CounterCount, 5, this);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("Subsystem")
+                                                     << tr("Last key (ms)")
+                                                     << tr("Avg/key (ms)")
+                                                     << tr("Max/key (ms)")
+                                                     << tr("Calls/key"));
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->verticalHeader()->hide();
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    for(int r = 0; r < PerfCounters::CounterCount; r++)
+        setCell(r, ColumnName, PerfCounters::name((PerfCounters::Counter)r));
+
+    m_labelSymbols = new QLabel(this);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(RefreshInterval);
+    connect(m_refreshTimer, SIGNAL(timeout()), this, SLOT(slotRefresh()));
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setMargin(2);
+    mainLayout->addWidget(m_table, 1);
+    mainLayout->addWidget(m_labelSymbols);
+    setLayout(mainLayout);
+}
+
+void PerfHudWidget::showEvent(QShowEvent *e)
+{
+    QWidget::showEvent(e);
+    PerfCounters::setEnabled(true);
+    m_refreshTimer->start();
+    slotRefresh();
+}
+
+void PerfHudWidget::hideEvent(QHideEvent *e)
+{
+    QWidget::hideEvent(e);
+    m_refreshTimer->stop();
+    PerfCounters::setEnabled(false);
+}
+
+void PerfHudWidget::slotRefresh()
+{
+    // "last key" is everything since the latest keystroke, the average and
+    // max cover the keystrokes before it
+    PerfCounters::Frame current = PerfCounters::current();
+    QList<PerfCounters::Frame> history = PerfCounters::history();
+
+    for(int r = 0; r < PerfCounters::CounterCount; r++)
+    {
+        qint64 total = 0;
+        int max = 0;
+        int calls = 0;
+        foreach(const PerfCounters::Frame &frame, history)
+        {
+            total += frame.time[r];
+            calls += frame.calls[r];
+            max = qMax(max, frame.time[r]);
+        }
+
+        setCell(r, ColumnLast, QString::number(current.time[r] / 1000.0, 'f', 2));
+        if(history.isEmpty())
+        {
+            setCell(r, ColumnAverage, "-");
+            setCell(r, ColumnMax, "-");
+            setCell(r, ColumnCalls, QString::number(current.calls[r]));
+        }
+        else
+        {
+            setCell(r, ColumnAverage, QString::number(total / 1000.0 / history.count(), 'f', 2));
+            setCell(r, ColumnMax, QString::number(max / 1000.0, 'f', 2));
+            setCell(r, ColumnCalls, QString::number(calls / history.count()));
+        }
+    }
+
+    m_labelSymbols->setText(tr("%1 keystrokes sampled, %2 symbols loaded, %3 blocks highlighted since the last key")
+                            .arg(history.count())
+                            .arg(PerfCounters::gauge(PerfCounters::SymbolsLoaded))
+                            .arg(current.calls[PerfCounters::HighlightBlock]));
+}
+
+void PerfHudWidget::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = m_table->item(row, column);
+    if(item == 0)
+    {
+        item = new QTableWidgetItem;
+        m_table->setItem(row, column, item);
+    }
+    item->setText(text);
+}
@@ -0,0 +1,63 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERFHUDWIDGET_H
+#define PERFHUDWIDGET_H
+
+#include <QWidget>
+
+class QTableWidget;
+class QLabel;
+class QTimer;
+
+class PerfHudWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PerfHudWidget(QWidget *parent = 0);
+
+protected:
+    void showEvent(QShowEvent *e);
+    void hideEvent(QHideEvent *e);
+
+private slots:
+    void slotRefresh();
+
+private:
+    enum Column
+    {
+        ColumnName = 0,
+        ColumnLast,
+        ColumnAverage,
+        ColumnMax,
+        ColumnCalls
+    };
+    enum
+    {
+        RefreshInterval = 250
+    };
+
+    QTableWidget *m_table;
+    QLabel *m_labelSymbols;
+    QTimer *m_refreshTimer;
+
+    void setCell(int row, int column, const QString &text);
+};
+
+#endif // PERFHUDWIDGET_H
@@ -0,0 +1,201 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pplotwidget.h"
+#include "qkide_global.h"
+
+#include <QPainter>
+#include <QTimer>
+#include <qnumeric.h>
+#include <limits>
+
+pPlotWidget::pPlotWidget(QWidget *parent) :
+    QWidget(parent),
+    m_historySize(0),
+    m_first(0),
+    m_count(0),
+    m_channels(0),
+    m_dirty(false)
+{
+    m_colors << QColor("#5AB4E8") << QColor("#F5EFB3") << QColor("#FD8679")
+             << QColor("#7FD67A") << QColor("#C59BE8") << QColor("#F2A65A")
+             << QColor("#E8E8E8") << QColor("#4FD1C5");
+
+    setHistorySize(10000);
+
+    // repaint at a fixed rate no matter how fast samples arrive
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setInterval(33);
+    connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(slotUpdate()));
+    m_updateTimer->start();
+}
+
+void pPlotWidget::setHistorySize(int samples)
+{
+    m_historySize = qMax(2, samples);
+    m_time.resize(m_historySize);
+    clear();
+}
+
+void pPlotWidget::addSample(qint64 time, const float *values, int count)
+{
+    while(m_channels < count)
+    {
+        QVector<float> channel(m_historySize, std::numeric_limits<float>::quiet_NaN());
+        m_values.append(channel);
+        m_channels++;
+    }
+
+    int i;
+    if(m_count < m_historySize)
+        i = index(m_count++);
+    else
+    {
+        i = m_first;
+        m_first = (m_first + 1) % m_historySize;
+    }
+
+    m_time[i] = time;
+    for(int ch = 0; ch < m_channels; ch++)
+        m_values[ch][i] = (ch < count ? values[ch] : std::numeric_limits<float>::quiet_NaN());
+
+    m_dirty = true;
+}
+
+void pPlotWidget::clear()
+{
+    m_first = 0;
+    m_count = 0;
+    m_channels = 0;
+    m_values.clear();
+    m_dirty = true;
+}
+
+QSize pPlotWidget::sizeHint() const
+{
+    return QSize(300, 150);
+}
+
+void pPlotWidget::slotUpdate()
+{
+    if(m_dirty && isVisible())
+    {
+        m_dirty = false;
+        update();
+    }
+}
+
+void pPlotWidget::paintEvent(QPaintEvent *e)
+{
+    Q_UNUSED(e);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor("#333"));
+
+    QRect area = rect().adjusted(4, 4, -4, -16);
+    if(m_count < 2 || area.width() < 2 || area.height() < 2)
+        return;
+
+    float lo = std::numeric_limits<float>::max();
+    float hi = -std::numeric_limits<float>::max();
+    for(int ch = 0; ch < m_channels; ch++)
+    {
+        const QVector<float> &values = m_values[ch];
+        for(int i = 0; i < m_count; i++)
+        {
+            float v = values[index(i)];
+            if(qIsNaN(v))
+                continue;
+            if(v < lo) lo = v;
+            if(v > hi) hi = v;
+        }
+    }
+    if(lo > hi)
+        return;
+    if(hi - lo < 1e-6f)
+    {
+        hi += 1.0f;
+        lo -= 1.0f;
+    }
+
+    double scaleY = area.height()/(double)(hi - lo);
+    int columns = qMin(area.width(), m_count);
+    double samplesPerColumn = m_count/(double)columns;
+    double columnWidth = area.width()/(double)columns;
+
+    for(int ch = 0; ch < m_channels; ch++)
+    {
+        const QVector<float> &values = m_values[ch];
+        QVector<QLineF> lines;
+        lines.reserve(columns*2);
+        QPointF last;
+        bool hasLast = false;
+
+        for(int col = 0; col < columns; col++)
+        {
+            int a = (int)(col*samplesPerColumn);
+            int b = qMin(m_count, qMax(a + 1, (int)((col + 1)*samplesPerColumn)));
+
+            float mn = std::numeric_limits<float>::max();
+            float mx = -std::numeric_limits<float>::max();
+            float first = 0.0f, end = 0.0f;
+            bool valid = false;
+            for(int i = a; i < b; i++)
+            {
+                float v = values[index(i)];
+                if(qIsNaN(v))
+                    continue;
+                if(!valid)
+                    first = v;
+                end = v;
+                valid = true;
+                if(v < mn) mn = v;
+                if(v > mx) mx = v;
+            }
+            if(!valid)
+            {
+                hasLast = false;
+                continue;
+            }
+
+            double x = area.left() + col*columnWidth;
+            if(hasLast)
+                lines.append(QLineF(last, QPointF(x, area.bottom() - (first - lo)*scaleY)));
+            if(mx > mn)
+                lines.append(QLineF(x, area.bottom() - (mn - lo)*scaleY,
+                                    x, area.bottom() - (mx - lo)*scaleY));
+            last = QPointF(x, area.bottom() - (end - lo)*scaleY);
+            hasLast = true;
+        }
+
+        painter.setPen(m_colors.at(ch % m_colors.count()));
+        painter.drawLines(lines);
+    }
+
+    painter.setPen(QColor("#aaa"));
+    painter.setFont(QFont(EDITOR_FONT_NAME, EDITOR_FONT_SIZE));
+    painter.drawText(area.left(), area.top() + painter.fontMetrics().ascent(),
+                     QString::number(hi));
+    painter.drawText(area.left(), area.bottom(), QString::number(lo));
+
+    int first = index(0), last = index(m_count - 1);
+    double seconds = (m_time[last] - m_time[first])/1e6;
+    painter.drawText(rect().adjusted(4, 0, -4, 0), Qt::AlignBottom | Qt::AlignRight,
+                     tr("%1 samples, %2 s").arg(m_count).arg(seconds, 0, 'f', 2));
+}
@@ -0,0 +1,66 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPLOTWIDGET_H
+#define PPLOTWIDGET_H
+
+#include <QWidget>
+#include <QVector>
+#include <QColor>
+
+class QTimer;
+
+/*
+ * Scrolling multi-channel plot. Samples are kept in a fixed size history
+ * and drawn decimated (min/max per pixel column), so painting cost
+ * depends on the widget width rather than on the sample rate.
+ */
+class pPlotWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit pPlotWidget(QWidget *parent = 0);
+
+    void setHistorySize(int samples);
+    void addSample(qint64 time, const float *values, int count);
+    void clear();
+
+    QSize sizeHint() const;
+
+protected:
+    void paintEvent(QPaintEvent *e);
+
+private slots:
+    void slotUpdate();
+
+private:
+    int m_historySize;
+    int m_first;
+    int m_count;
+    int m_channels;
+    QVector<qint64> m_time;
+    QVector< QVector<float> > m_values;
+    QList<QColor> m_colors;
+    QTimer *m_updateTimer;
+    bool m_dirty;
+
+    int index(int i) const { return (m_first + i) % m_historySize; }
+};
+
+#endif // PPLOTWIDGET_H
@@ -0,0 +1,239 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "searchwidget.h"
+#include "projectsearch.h"
+#include "qkide_global.h"
+
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QTreeWidget>
+#include <QLabel>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QThread>
+#include <QTimer>
+#include <QDir>
+
+SearchWidget::SearchWidget(QWidget *parent) :
+    QWidget(parent),
+    m_searchId(0)
+{
+    m_searchThread = new QThread(this);
+    m_search = new ProjectSearch;
+    m_search->moveToThread(m_searchThread);
+    connect(m_searchThread, SIGNAL(finished()), m_search, SLOT(deleteLater()));
+    connect(this, SIGNAL(startSearch(int,QStringList,QString,int,QStringList,QStringList)),
+            m_search, SLOT(search(int,QStringList,QString,int,QStringList,QStringList)));
+    connect(m_search, SIGNAL(found(int,QList<SearchMatch>)),
+            this, SLOT(slotFound(int,QList<SearchMatch>)));
+    connect(m_search, SIGNAL(finished(int,int,int)), this, SLOT(slotFinished(int,int,int)));
+    m_searchThread->start(QThread::LowPriority);
+
+    m_typingTimer = new QTimer(this);
+    m_typingTimer->setSingleShot(true);
+    m_typingTimer->setInterval(TypingDelay);
+    connect(m_typingTimer, SIGNAL(timeout()), this, SLOT(slotSearch()));
+
+    m_lineQuery = new QLineEdit(this);
+    m_lineQuery->setPlaceholderText(tr("Find in project"));
+    connect(m_lineQuery, SIGNAL(textEdited(QString)), m_typingTimer, SLOT(start()));
+    connect(m_lineQuery, SIGNAL(returnPressed()), this, SLOT(slotSearch()));
+
+    m_checkCase = new QCheckBox(tr("Match case"), this);
+    connect(m_checkCase, SIGNAL(toggled(bool)), this, SLOT(slotSearch()));
+    m_checkWords = new QCheckBox(tr("Whole words"), this);
+    connect(m_checkWords, SIGNAL(toggled(bool)), this, SLOT(slotSearch()));
+    m_checkSdk = new QCheckBox(tr("Include SDK"), this);
+    connect(m_checkSdk, SIGNAL(toggled(bool)), this, SLOT(slotSearch()));
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setHeaderHidden(true);
+    m_tree->setUniformRowHeights(true);
+    m_tree->setFont(QFont(EDITOR_FONT_NAME, EDITOR_FONT_SIZE));
+    connect(m_tree, SIGNAL(itemActivated(QTreeWidgetItem*,int)),
+            this, SLOT(slotItemActivated(QTreeWidgetItem*)));
+
+    m_labelStatus = new QLabel(this);
+
+    QHBoxLayout *queryLayout = new QHBoxLayout;
+    queryLayout->addWidget(m_lineQuery, 1);
+    queryLayout->addWidget(m_checkCase);
+    queryLayout->addWidget(m_checkWords);
+    queryLayout->addWidget(m_checkSdk);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setMargin(2);
+    mainLayout->addLayout(queryLayout);
+    mainLayout->addWidget(m_tree, 1);
+    mainLayout->addWidget(m_labelStatus);
+    setLayout(mainLayout);
+}
+
+SearchWidget::~SearchWidget()
+{
+    m_search->setCurrent(-1);
+    m_searchThread->quit();
+    m_searchThread->wait();
+}
+
+void SearchWidget::setProjectPath(const QString &path)
+{
+    m_projectPath = path;
+    m_tree->clear();
+    m_labelStatus->clear();
+}
+
+void SearchWidget::setSdkPaths(const QStringList &paths)
+{
+    m_sdkPaths = paths;
+}
+
+void SearchWidget::setOpenFiles(const QStringList &paths, const QStringList &texts)
+{
+    m_openPaths = paths;
+    m_openTexts = texts;
+}
+
+void SearchWidget::setQuery(const QString &text)
+{
+    m_lineQuery->setText(text);
+    m_lineQuery->selectAll();
+    m_lineQuery->setFocus();
+    slotSearch();
+}
+
+void SearchWidget::findReferences(const QString &symbol)
+{
+    // the options apply to this search only, the checkboxes are left as
+    // the user set them
+    m_lineQuery->setText(symbol);
+    m_lineQuery->selectAll();
+    m_lineQuery->setFocus();
+    search(symbol, ProjectSearch::CaseSensitive | ProjectSearch::WholeWords, true);
+}
+
+void SearchWidget::slotSearch()
+{
+    int flags = 0;
+    if(m_checkCase->isChecked())
+        flags |= ProjectSearch::CaseSensitive;
+    if(m_checkWords->isChecked())
+        flags |= ProjectSearch::WholeWords;
+
+    search(m_lineQuery->text(), flags, m_checkSdk->isChecked());
+}
+
+void SearchWidget::search(const QString &query, int flags, bool includeSdk)
+{
+    m_typingTimer->stop();
+    m_tree->clear();
+
+    m_search->setCurrent(++m_searchId);
+    if(query.size() < MinQueryLength || m_projectPath.isEmpty())
+    {
+        m_labelStatus->clear();
+        return;
+    }
+
+    m_openPaths.clear();
+    m_openTexts.clear();
+    emit aboutToSearch();
+
+    QStringList roots;
+    roots << m_projectPath;
+    if(includeSdk)
+        roots << m_sdkPaths;
+
+    m_labelStatus->setText(tr("Searching..."));
+    emit startSearch(m_searchId, roots, query, flags, m_openPaths, m_openTexts);
+}
+
+int SearchWidget::beginMatches(const QString &description)
+{
+    // results produced elsewhere, a running project search is dropped
+    m_typingTimer->stop();
+    m_search->setCurrent(++m_searchId);
+    m_tree->clear();
+    m_labelStatus->setText(description);
+    return m_searchId;
+}
+
+void SearchWidget::appendMatches(int id, const QList<SearchMatch> &matches)
+{
+    if(id != m_searchId)
+        return;
+    addMatches(matches);
+}
+
+void SearchWidget::finishMatches(int id, const QString &description)
+{
+    if(id != m_searchId)
+        return;
+    m_labelStatus->setText(description);
+}
+
+void SearchWidget::slotFound(int id, const QList<SearchMatch> &matches)
+{
+    if(id != m_searchId)
+        return;
+    addMatches(matches);
+}
+
+void SearchWidget::slotFinished(int id, int files, int matches)
+{
+    if(id != m_searchId)
+        return;
+    m_labelStatus->setText(tr("%1 matches in %2 files").arg(matches).arg(files));
+}
+
+void SearchWidget::slotItemActivated(QTreeWidgetItem *item)
+{
+    emit openLocation(item->data(0, Qt::UserRole).toString(),
+                      item->data(0, Qt::UserRole + 1).toInt(),
+                      item->data(0, Qt::UserRole + 2).toInt());
+}
+
+void SearchWidget::addMatches(const QList<SearchMatch> &matches)
+{
+    if(matches.isEmpty())
+        return;
+
+    QString filePath = matches.first().filePath;
+    QString displayPath = filePath;
+    if(displayPath.startsWith(QDir::cleanPath(m_projectPath) + "/"))
+        displayPath = displayPath.mid(QDir::cleanPath(m_projectPath).size() + 1);
+
+    QTreeWidgetItem *fileItem = new QTreeWidgetItem(m_tree);
+    fileItem->setText(0, QString("%1 (%2)").arg(QDir::toNativeSeparators(displayPath))
+                                           .arg(matches.count()));
+    fileItem->setData(0, Qt::UserRole, filePath);
+    fileItem->setData(0, Qt::UserRole + 1, 1);
+    fileItem->setData(0, Qt::UserRole + 2, 0);
+
+    foreach(const SearchMatch &match, matches)
+    {
+        QTreeWidgetItem *item = new QTreeWidgetItem(fileItem);
+        item->setText(0, QString("%1: %2").arg(match.line).arg(match.text));
+        item->setData(0, Qt::UserRole, match.filePath);
+        item->setData(0, Qt::UserRole + 1, match.line);
+        item->setData(0, Qt::UserRole + 2, match.column);
+    }
+    fileItem->setExpanded(true);
+}
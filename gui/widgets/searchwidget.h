@@ -0,0 +1,94 @@
+/*
+ * QkThings LICENSE
+ * The open source framework and modular platform for smart devices.
+ * Copyright (C) 2014 <http://qkthings.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEARCHWIDGET_H
+#define SEARCHWIDGET_H
+
+#include <QWidget>
+#include <QStringList>
+#include "searchindex.h"
+
+class ProjectSearch;
+class QLineEdit;
+class QCheckBox;
+class QTreeWidget;
+class QTreeWidgetItem;
+class QLabel;
+class QThread;
+class QTimer;
+
+class SearchWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SearchWidget(QWidget *parent = 0);
+    ~SearchWidget();
+
+    void setProjectPath(const QString &path);
+    void setSdkPaths(const QStringList &paths);
+    void setOpenFiles(const QStringList &paths, const QStringList &texts);
+    void setQuery(const QString &text);
+    void findReferences(const QString &symbol);
+    int beginMatches(const QString &description);
+    void appendMatches(int id, const QList<SearchMatch> &matches);
+    void finishMatches(int id, const QString &description);
+
+signals:
+    void aboutToSearch();
+    void openLocation(QString filePath, int line, int column);
+    void startSearch(int id, QStringList roots, QString query, int flags,
+                     QStringList openPaths, QStringList openTexts);
+
+public slots:
+    void slotSearch();
+
+private slots:
+    void slotFound(int id, const QList<SearchMatch> &matches);
+    void slotFinished(int id, int files, int matches);
+    void slotItemActivated(QTreeWidgetItem *item);
+
+private:
+    enum
+    {
+        TypingDelay = 250,
+        MinQueryLength = 2
+    };
+
+    ProjectSearch *m_search;
+    QThread *m_searchThread;
+    QTimer *m_typingTimer;
+    int m_searchId;
+
+    QString m_projectPath;
+    QStringList m_sdkPaths;
+    QStringList m_openPaths;
+    QStringList m_openTexts;
+
+    QLineEdit *m_lineQuery;
+    QCheckBox *m_checkCase;
+    QCheckBox *m_checkWords;
+    QCheckBox *m_checkSdk;
+    QTreeWidget *m_tree;
+    QLabel *m_labelStatus;
+
+    void search(const QString &query, int flags, bool includeSdk);
+    void addMatches(const QList<SearchMatch> &matches);
+};
+
+#endif // SEARCHWIDGET_H
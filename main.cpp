@@ -24,11 +24,33 @@
 #include <QStyleFactory>
 #include <QFontDatabase>
 #include <QSplashScreen>
+#include <QTextStream>
 #include "qkide.h"
+#include "startupprofiler.h"
+#include "builder.h"
 
 int main(int argc, char *argv[])
 {
+    // --build/--upload run make on a project without creating any widget
+    if(Builder::isHeadless(argc, argv))
+    {
+        QCoreApplication a(argc, argv);
+        a.setOrganizationDomain(QK_IDE_DOMAIN_STR);
+        a.setApplicationName(QK_IDE_NAME_STR);
+        return Builder::run(a.arguments());
+    }
+
+    // --replay runs on the offscreen platform unless told otherwise
+    for(int i = 1; i < argc; i++)
+        if(qstrcmp(argv[i], "--replay") == 0 && qgetenv("QT_QPA_PLATFORM").isEmpty())
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    StartupProfiler::start();
+
+    StartupProfiler::begin("application");
     QApplication a(argc, argv);
+    QStringList arguments = a.arguments();
+    bool startupProfile = arguments.contains("--startup-profile");
 
     a.setOrganizationDomain(QK_IDE_DOMAIN_STR);
     a.setApplicationName(QK_IDE_NAME_STR);
@@ -37,10 +59,12 @@ int main(int argc, char *argv[])
     QSplashScreen splash(pixmap);
     splash.show();
     a.processEvents();
+    StartupProfiler::end();
 
     QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, a.applicationDirPath());
     QSettings::setDefaultFormat(QSettings::IniFormat);
 
+    StartupProfiler::begin("fonts and style");
     QFontDatabase::addApplicationFont("://fonts/Monaco.ttf");
     QFontDatabase::addApplicationFont("://fonts/Ubuntu-R.ttf");
     QFontDatabase::addApplicationFont("://fonts/Roboto-Regular.ttf");
@@ -49,10 +73,34 @@ int main(int argc, char *argv[])
 
     QStyle *style = QStyleFactory::create("Fusion");
     a.setStyle(style);
+    StartupProfiler::end();
 
+    StartupProfiler::begin("main window");
     QkIDE w;
+    StartupProfiler::end();
+
+    StartupProfiler::begin("show");
     splash.hide();
     w.show();
-    
+    a.processEvents();
+    StartupProfiler::end();
+
+    // --startup-profile also writes a chrome://tracing file and quits
+    QString report = StartupProfiler::finish(a.applicationDirPath() + TEMP_DIR, startupProfile);
+    if(startupProfile)
+    {
+        QTextStream(stdout) << report;
+        return 0;
+    }
+
+    int record = arguments.indexOf("--record");
+    if(record != -1 && record + 1 < arguments.count())
+        w.recordEvents(arguments.at(record + 1));
+
+    int replay = arguments.indexOf("--replay");
+    if(replay != -1 && (replay + 1 >= arguments.count() ||
+                        !w.replayEvents(arguments.at(replay + 1))))
+        return 1;
+
     return a.exec();
 }
@@ -24,12 +24,26 @@
 #include "theme.h"
 #include "project.h"
 #include "projectwizard.h"
+#include "batchuploader.h"
+#include "batchuploaddialog.h"
+#include "builder.h"
+#include "buildmatrix.h"
+#include "buildmatrixdialog.h"
+#include "serialportmonitor.h"
+#include "editjournal.h"
+#include "occurrenceindex.h"
+#include "startupprofiler.h"
+#include "eventrecorder.h"
+#include "stallwatchdog.h"
+#include "applog.h"
 #include "ptextdock.h"
 #include "browser.h"
 #include "editor/editor.h"
 #include "editor/codeparser.h"
 #include "editor/highlighter.h"
 #include "editor/completer.h"
+#include "editor/semanticindexer.h"
+#include "editor/syntaxdefinition.h"
 
 #include "core/optionsdialog.h"
 #include "ui_optionsdialog.h"
@@ -37,6 +51,11 @@
 #include "qkconnect.h"
 #include "qkconnserial.h"
 #include "qkreferencewidget.h"
+#include "dataloggerwidget.h"
+#include "searchwidget.h"
+#include "perfhudwidget.h"
+#include "logviewerwidget.h"
+#include "textfile.h"
 #include "qkexplorerwidget.h"
 
 #include <QtGlobal>
@@ -55,12 +74,15 @@
 #include <QStackedWidget>
 #include <QVBoxLayout>
 #include <QRegExp>
+#include <QThread>
+#include <QTimer>
 #include <QtSerialPort/QSerialPortInfo>
 
 QkIDE::QkIDE(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::QkIDE)
 {
+    StartupProfiler::begin("ui setup");
     ui->setupUi(this);
 
     m_optionsDialog = new OptionsDialog(this);
@@ -75,6 +97,8 @@ QkIDE::QkIDE(QWidget *parent) :
     connect(m_browser, SIGNAL(openRecentProject(int)), this, SLOT(slotOpenRecentProject(int)));
 
     m_editor = new Editor(this);
+    connect(m_editor, SIGNAL(pageCreated(Page*)), this, SLOT(slotPageCreated(Page*)));
+    connect(m_editor, SIGNAL(pageWritten(Page*)), this, SLOT(slotPageWritten(Page*)));
 
     m_stackedWidget = new QStackedWidget();
     m_stackedWidget->addWidget(m_browser);
@@ -113,6 +137,21 @@ QkIDE::QkIDE(QWidget *parent) :
     connect(m_uploadProcess, SIGNAL(readyRead()), this, SLOT(slotUploadProcessOutput()));
     connect(m_uploadProcess, SIGNAL(finished(int)), this, SLOT(slotUploadProcessFinished()));
 
+    m_batchUploader = new BatchUploader(this);
+    connect(m_batchUploader, SIGNAL(finished()), this, SLOT(slotBatchUploadFinished()));
+    m_batchUploadDialog = new BatchUploadDialog(m_batchUploader, this);
+    m_batchUploadDialog->hide();
+    connect(m_batchUploadDialog, SIGNAL(uploadRequested(QStringList)),
+            this, SLOT(slotStartBatchUpload(QStringList)));
+
+    m_buildMatrix = new BuildMatrix(this);
+    connect(m_buildMatrix, SIGNAL(finished()), this, SLOT(slotBuildMatrixFinished()));
+    m_buildMatrixDialog = new BuildMatrixDialog(m_buildMatrix, this);
+    m_buildMatrixDialog->hide();
+    connect(m_buildMatrixDialog, SIGNAL(buildRequested(QStringList)),
+            this, SLOT(slotStartBuildMatrix(QStringList)));
+
+    StartupProfiler::end();
 
     QDir().mkdir(QApplication::applicationDirPath() + TEMP_DIR);
     QDir().mkdir(QApplication::applicationDirPath() + TAGS_DIR);
@@ -121,9 +160,18 @@ QkIDE::QkIDE(QWidget *parent) :
 
     QString qkprogramDir = QApplication::applicationDirPath() + QKPROGRAM_INC_DIR;
 
+    StartupProfiler::begin("sdk parse");
     CodeParser *parser = m_codeParser;
     parser->parse(qkprogramDir);
     m_libElements.append(parser->allElements());
+    m_libTags = parser->tags();
+    m_symbolIndex.setLibrary(m_libTags);
+
+    // only for the preprocessor, the makefile puts these on the include path
+    CodeParser peripheralParser;
+    peripheralParser.parse(QApplication::applicationDirPath() + QKPERIPHERAL_DIR + "/include");
+    m_peripheralTags = peripheralParser.tags();
+    StartupProfiler::end();
 
     m_parserTimer = new QTimer(this);
     m_parserTimer->setInterval(500);
@@ -134,44 +182,152 @@ QkIDE::QkIDE(QWidget *parent) :
     connect(this, SIGNAL(currentProjectChanged()), this, SLOT(slotCurrentProjectChanged()));
 
 
+    StartupProfiler::begin("targets");
     m_targets = QkUtils::supportedTargets(qApp->applicationDirPath() + EMB_DIR);
+    StartupProfiler::end();
 
     m_optionsDialog->setTargets(m_targets);
 
-    m_serialConn = new QkConnSerial(m_uploadPortName, 38400, this);
-    m_serialConn->setSearchOnConnect(true);
-    connect(m_serialConn, SIGNAL(error(QString)), this, SLOT(slotError(QString)));
-
-    m_explorerWindow = new QMainWindow(this);
-    m_explorerWindow->hide();
-
-    m_explorerWidget = new QkExplorerWidget(m_explorerWindow);
-
-    m_explorerWidget->setConnection(m_serialConn);
-    m_explorerWidget->setModes(QkExplorerWidget::ModeSingleNode |
-                               QkExplorerWidget::ModeSingleConnection);
-    m_explorerWidget->setFeatures(QkExplorerWidget::FeatureDockableWidgets);
-    m_explorerWindow->setCentralWidget(m_explorerWidget);
-
-
-    connect(m_serialConn, SIGNAL(error(QString)), m_explorerWidget, SLOT(showError(QString)));
-
-    createReference();
+    // created on first use, see createExplorer() and createReference()
+    m_serialConn = 0;
+    m_explorerWindow = 0;
+    m_explorerWidget = 0;
+    m_referenceWindow = 0;
+    m_referenceWidget = 0;
+
+    m_dataLoggerDock = new QDockWidget(tr("Data Logger"), this);
+    m_dataLoggerDock->setObjectName("dataLoggerDock");
+    m_dataLoggerWidget = new DataLoggerWidget(m_dataLoggerDock);
+    m_dataLoggerDock->setWidget(m_dataLoggerWidget);
+    m_dataLoggerDock->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::RightDockWidgetArea);
+    m_dataLoggerDock->hide();
+    connect(m_dataLoggerWidget, SIGNAL(aboutToCapture(QString)), this, SLOT(slotReleaseSerialPort()));
+
+    m_searchDock = new QDockWidget(tr("Find in Project"), this);
+    m_searchDock->setObjectName("searchDock");
+    m_searchWidget = new SearchWidget(m_searchDock);
+    m_searchWidget->setSdkPaths(QStringList()
+                                << QApplication::applicationDirPath() + QKPROGRAM_DIR
+                                << QApplication::applicationDirPath() + QKPERIPHERAL_DIR
+                                << QApplication::applicationDirPath() + QKDSP_DIR);
+    m_searchDock->setWidget(m_searchWidget);
+    m_searchDock->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::RightDockWidgetArea);
+    m_searchDock->hide();
+    connect(m_searchWidget, SIGNAL(aboutToSearch()), this, SLOT(slotSearchAboutToStart()));
+    connect(m_searchWidget, SIGNAL(openLocation(QString,int,int)),
+            this, SLOT(slotOpenLocation(QString,int,int)));
+
+    m_perfDock = new QDockWidget(tr("Performance"), this);
+    m_perfDock->setObjectName("perfDock");
+    m_perfHudWidget = new PerfHudWidget(m_perfDock);
+    m_perfDock->setWidget(m_perfHudWidget);
+    m_perfDock->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::RightDockWidgetArea);
+    m_perfDock->hide();
+
+    m_logDock = new QDockWidget(tr("Log"), this);
+    m_logDock->setObjectName("logDock");
+    m_logViewerWidget = new LogViewerWidget(m_logDock);
+    m_logDock->setWidget(m_logViewerWidget);
+    m_logDock->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::RightDockWidgetArea);
+    m_logDock->hide();
+
+    StartupProfiler::begin("actions and menus");
     createActions();
     createMenus();
     createToolbars();
+    StartupProfiler::end();
+
+    StartupProfiler::begin("examples");
     createExamples();
+    StartupProfiler::end();
 
+    StartupProfiler::begin("settings");
     readSettings();
+    StartupProfiler::end();
+
+    StartupProfiler::begin("theme");
     setTheme(DEFAULT_THEME);
+    StartupProfiler::end();
+
+    StartupProfiler::begin("layout");
     setupLayout();
+    StartupProfiler::end();
+
+    StartupProfiler::begin("workers");
+
+    m_portMonitorThread = new QThread(this);
+    m_portMonitor = new SerialPortMonitor;
+    m_portMonitor->moveToThread(m_portMonitorThread);
+    connect(m_portMonitorThread, SIGNAL(started()), m_portMonitor, SLOT(start()));
+    connect(m_portMonitorThread, SIGNAL(finished()), m_portMonitor, SLOT(deleteLater()));
+    connect(m_portMonitor, SIGNAL(portAdded(QString)), this, SLOT(slotSerialPortAdded(QString)));
+    connect(m_portMonitor, SIGNAL(portRemoved(QString)), this, SLOT(slotSerialPortRemoved(QString)));
+    m_portMonitorThread->start(QThread::LowPriority);
+
+    m_journalThread = new QThread(this);
+    m_journal = new EditJournal;
+    m_journal->moveToThread(m_journalThread);
+    connect(m_journalThread, SIGNAL(started()), m_journal, SLOT(start()));
+    connect(m_journalThread, SIGNAL(finished()), m_journal, SLOT(deleteLater()));
+    m_journalThread->start(QThread::LowPriority);
+
+    m_occurrenceThread = new QThread(this);
+    m_occurrenceIndex = new OccurrenceIndex(QApplication::applicationDirPath() + TEMP_DIR + "/xref.idx");
+    m_occurrenceIndex->moveToThread(m_occurrenceThread);
+    connect(m_occurrenceIndex, SIGNAL(previewsFound(int,QList<SearchMatch>)),
+            this, SLOT(slotOccurrencesFound(int,QList<SearchMatch>)));
+    connect(m_occurrenceIndex, SIGNAL(previewsFinished(int,int)),
+            this, SLOT(slotOccurrencesFinished(int,int)));
+    connect(m_occurrenceThread, SIGNAL(started()), m_occurrenceIndex, SLOT(start()));
+    connect(m_occurrenceThread, SIGNAL(finished()), m_occurrenceIndex, SLOT(deleteLater()));
+    m_occurrenceThread->start(QThread::LowPriority);
+
+    m_eventRecorder = 0;
+
+    m_stallWatchdog = new StallWatchdog(m_stallThreshold, this);
+    connect(m_stallWatchdog, SIGNAL(stalled(int,QString)), this, SLOT(slotStalled(int,QString)));
+    m_stallWatchdog->start(QThread::HighPriority);
+
+    m_semanticIndexer = 0;
+    m_semanticThread = 0;
+    if(SemanticIndexer::isAvailable())
+    {
+        m_semanticThread = new QThread(this);
+        m_semanticIndexer = new SemanticIndexer(QApplication::applicationDirPath() + TEMP_DIR + "/semantic");
+        m_semanticIndexer->moveToThread(m_semanticThread);
+        connect(m_semanticThread, SIGNAL(finished()), m_semanticIndexer, SLOT(deleteLater()));
+        m_semanticThread->start(QThread::LowPriority);
+    }
+    StartupProfiler::end();
 
-    slotReloadSerialPorts();
     updateInterface();
+
+    // warm up after a few seconds without user input
+    m_warmUpTimer = new QTimer(this);
+    m_warmUpTimer->setSingleShot(true);
+    m_warmUpTimer->setInterval(WarmUpDelay);
+    connect(m_warmUpTimer, SIGNAL(timeout()), this, SLOT(slotWarmUp()));
+    m_warmUpTimer->start();
+    qApp->installEventFilter(this);
 }
 
 QkIDE::~QkIDE()
 {
+    m_stallWatchdog->writeLog(QApplication::applicationDirPath() + TEMP_DIR + "/stalls.log");
+    if(m_eventRecorder != 0)
+        m_eventRecorder->stopRecording();
+    m_portMonitorThread->quit();
+    m_portMonitorThread->wait();
+    m_journal->waitForIdle();
+    m_journalThread->quit();
+    m_journalThread->wait();
+    m_occurrenceThread->quit();
+    m_occurrenceThread->wait();
+    if(m_semanticThread != 0)
+    {
+        m_semanticThread->quit();
+        m_semanticThread->wait();
+    }
     delete ui;
 }
 
@@ -181,6 +337,10 @@ void QkIDE::createActions()
     m_searchAct->setShortcuts(QKeySequence::Find);
     connect(m_searchAct, SIGNAL(triggered()), this, SLOT(slotSearch()));
 
+    m_findInProjectAct = new QAction(tr("Find in Project..."), this);
+    m_findInProjectAct->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_F));
+    connect(m_findInProjectAct, SIGNAL(triggered()), this, SLOT(slotFindInProject()));
+
     m_homeAct = new QAction(QIcon(":/img/home.png"), "", this);
     m_homeAct->setCheckable(true);
     m_homeAct->setChecked(true);
@@ -233,6 +393,12 @@ void QkIDE::createActions()
     connect(m_cleanAct, SIGNAL(triggered()), this, SLOT(slotClean()));
     connect(m_verifyAct, SIGNAL(triggered()), this, SLOT(slotVerify()));
     connect(m_uploadAct, SIGNAL(triggered()), this, SLOT(slotUpload()));
+    m_batchUploadAct = new QAction(tr("Batch Upload..."),this);
+    m_batchUploadAct->setStatusTip(tr("Upload to several boards at once"));
+    connect(m_batchUploadAct, SIGNAL(triggered()), this, SLOT(slotBatchUpload()));
+    m_verifyAllAct = new QAction(tr("Verify All Targets..."),this);
+    m_verifyAllAct->setStatusTip(tr("Build the project for every supported target"));
+    connect(m_verifyAllAct, SIGNAL(triggered()), this, SLOT(slotVerifyAllTargets()));
 
     m_referenceAct = new QAction(QIcon(":/img/reference_16.png"), tr("Show Reference"), this);
     connect(m_referenceAct, SIGNAL(triggered()), this, SLOT(slotShowReference()));
@@ -240,6 +406,10 @@ void QkIDE::createActions()
     m_explorerAct = new QAction(QIcon(":/img/explorer.png"), tr("Show Explorer"), this);
     connect(m_explorerAct, SIGNAL(triggered()), this, SLOT(slotShowExplorer()));
 
+    m_dataLoggerAct = new QAction(tr("Data Logger"), this);
+    m_dataLoggerAct->setStatusTip(tr("Record and plot serial data"));
+    connect(m_dataLoggerAct, SIGNAL(triggered()), this, SLOT(slotShowDataLogger()));
+
 //    m_targetAct = new QAction(QIcon(":/img/target_16.png"), tr("Show Target"), this);
 //    connect(m_targetAct, SIGNAL(triggered()), this, SLOT(slotShowHideTarget()));
 
@@ -263,6 +433,9 @@ void QkIDE::createActions()
     connect(m_removeSplitAct, SIGNAL(triggered()), this, SLOT(slotRemoveSplit()));
     m_removeSplitAct->setEnabled(false);
 
+    m_showStallsAct = new QAction(tr("UI Stalls"), this);
+    connect(m_showStallsAct, SIGNAL(triggered()), this, SLOT(slotShowStalls()));
+
     m_optionsAct = new QAction(tr("Options..."), this);
     connect(m_optionsAct, SIGNAL(triggered()), this, SLOT(slotOptions()));
 
@@ -311,6 +484,7 @@ void QkIDE::createMenus()
     m_editMenu->addAction(m_redoAct);
     m_editMenu->addSeparator();
     m_editMenu->addAction(m_searchAct);
+    m_editMenu->addAction(m_findInProjectAct);
 
     m_projectMenu->addAction(m_createProjectAct);
     m_projectMenu->addAction(m_openProjectAct);
@@ -322,7 +496,9 @@ void QkIDE::createMenus()
 //    m_projectMenu->addAction(m_ProjectPreferencesAct);
 //    m_projectMenu->addSeparator();
     m_projectMenu->addAction(m_verifyAct);
+    m_projectMenu->addAction(m_verifyAllAct);
     m_projectMenu->addAction(m_uploadAct);
+    m_projectMenu->addAction(m_batchUploadAct);
 
 //    m_toolsMenu->addAction(m_optionsAct);
 
@@ -331,6 +507,10 @@ void QkIDE::createMenus()
     m_windowMenu->addAction(m_splitHorizontalAct);
     m_windowMenu->addAction(m_splitVerticalAct);
     m_windowMenu->addAction(m_removeSplitAct);
+    m_windowMenu->addSeparator();
+    m_windowMenu->addAction(m_perfDock->toggleViewAction());
+    m_windowMenu->addAction(m_showStallsAct);
+    m_windowMenu->addAction(m_logDock->toggleViewAction());
 
     m_helpMenu->addAction(m_aboutAct);
 
@@ -398,6 +578,7 @@ void QkIDE::createToolbars()
     m_comboTargetVariant->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Fixed);
 
     connect(m_comboTargetName, SIGNAL(currentIndexChanged(int)), this, SLOT(updateInterface()));
+    connect(m_comboTargetVariant, SIGNAL(currentIndexChanged(int)), this, SLOT(slotTargetChanged()));
 
 //    m_comboBaud = new QComboBox(m_qkToolbar);
 //    m_comboBaud->addItem("38400");
@@ -410,6 +591,7 @@ void QkIDE::createToolbars()
     m_qkToolbar->addWidget(spacer);
     m_qkToolbar->addAction(m_referenceAct);
     m_qkToolbar->addAction(m_explorerAct);
+    m_qkToolbar->addAction(m_dataLoggerAct);
 //    m_qkToolbar->addWidget(m_comboTarget);
 //    m_qkToolbar->addSeparator();
 //    m_qkToolbar->addAction(m_targetAct);
@@ -426,7 +608,7 @@ void QkIDE::createToolbars()
 
 void QkIDE::createExamples()
 {
-    qDebug() << "create examples";
+    qkLog(Project) << "create examples";
 
     QMenu *menu;
     QDir projectsDir, topicsDir(qApp->applicationDirPath() + "/examples");
@@ -445,7 +627,7 @@ void QkIDE::createExamples()
         projectsDir.setPath(path);
 
         projectNames = projectsDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
-        qDebug() << projectsDir.path() << projectNames;
+        qkLog(Project) << projectsDir.path() << projectNames;
         foreach(QString project, projectNames)
         {
             QAction *act = menu->addAction(project);
@@ -463,7 +645,10 @@ void QkIDE::createExamples()
 
 void QkIDE::createReference()
 {
-    qDebug() << __FUNCTION__;
+    if(m_referenceWindow != 0)
+        return;
+
+    qkLog(Project) << __FUNCTION__;
 
     m_referenceWindow = new QMainWindow(this);
     m_referenceWindow->hide();
@@ -473,18 +658,73 @@ void QkIDE::createReference()
     m_referenceWindow->setWindowTitle("QkReference");
 }
 
+void QkIDE::createExplorer()
+{
+    if(m_explorerWidget != 0)
+        return;
+
+    qkLog(Project) << __FUNCTION__;
+
+    m_serialConn = new QkConnSerial(m_uploadPortName, 38400, this);
+    m_serialConn->setSearchOnConnect(true);
+    connect(m_serialConn, SIGNAL(error(QString)), this, SLOT(slotError(QString)));
+
+    m_explorerWindow = new QMainWindow(this);
+    m_explorerWindow->hide();
+
+    m_explorerWidget = new QkExplorerWidget(m_explorerWindow);
+
+    m_explorerWidget->setConnection(m_serialConn);
+    m_explorerWidget->setModes(QkExplorerWidget::ModeSingleNode |
+                               QkExplorerWidget::ModeSingleConnection);
+    m_explorerWidget->setFeatures(QkExplorerWidget::FeatureDockableWidgets);
+    m_explorerWindow->setCentralWidget(m_explorerWidget);
+
+    connect(m_serialConn, SIGNAL(error(QString)), m_explorerWidget, SLOT(showError(QString)));
+}
+
+bool QkIDE::eventFilter(QObject *obj, QEvent *e)
+{
+    switch(e->type())
+    {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+        if(m_warmUpTimer->isActive())
+            m_warmUpTimer->start();
+        break;
+    default:
+        break;
+    }
+    return QMainWindow::eventFilter(obj, e);
+}
+
+void QkIDE::slotWarmUp()
+{
+    // one window per idle turn, so the interface stays responsive
+    if(m_referenceWindow == 0)
+    {
+        createReference();
+        QTimer::singleShot(0, this, SLOT(slotWarmUp()));
+    }
+    else
+    {
+        createExplorer();
+        qApp->removeEventFilter(this);
+    }
+}
+
 
 void QkIDE::setupLayout()
 {
     setDockOptions(QMainWindow::AllowNestedDocks);
 
     addDockWidget(Qt::BottomDockWidgetArea, m_outputWindow);
-
-    foreach(QDockWidget *dock, m_explorerWidget->docks())
-    {
-        dock->setParent(this);
-        addDockWidget(Qt::RightDockWidgetArea, dock);
-    }
+    addDockWidget(Qt::BottomDockWidgetArea, m_dataLoggerDock);
+    addDockWidget(Qt::BottomDockWidgetArea, m_searchDock);
+    addDockWidget(Qt::RightDockWidgetArea, m_perfDock);
+    addDockWidget(Qt::BottomDockWidgetArea, m_logDock);
 
     updateRecentProjects();
 
@@ -519,6 +759,12 @@ void QkIDE::readSettings()
     //settings.beginGroup("preferences");
     m_uploadPortName = settings.value("serialPort").toString();
     m_projectDefaultLocation = settings.value("projectDefaultPath").toString();
+    m_stallThreshold = settings.value("stallThreshold", DefaultStallThreshold).toInt();
+#ifdef QT_NO_DEBUG
+    AppLog::setRules(settings.value("logCategories").toString());
+#else
+    AppLog::setRules(settings.value("logCategories", "*").toString());
+#endif
     //settings.endGroup();
 
     size = settings.beginReadArray("RecentProjects");
@@ -558,8 +804,10 @@ void QkIDE::writeSettings()
     settings.endArray();
 
     settings.setValue("projectDefaultPath", QVariant(m_projectDefaultLocation));
+    settings.setValue("stallThreshold", QVariant(m_stallThreshold));
+    settings.setValue("logCategories", QVariant(AppLog::rules()));
 
-    qDebug() << "settings written";
+    qkLog(Project) << "settings written";
 }
 
 void QkIDE::slotHome(bool go)
@@ -610,7 +858,7 @@ void QkIDE::slotOpenExample()
     QAction *action = qobject_cast<QAction *>(sender());
     if(action == 0) return;
 
-    qDebug() << "open example" << action->data().toString();
+    qkLog(Project) << "open example" << action->data().toString();
 
     openProject(action->data().toString());
 }
@@ -620,7 +868,7 @@ void QkIDE::slotOpenRecentProject()
     QAction *action = qobject_cast<QAction *>(sender());
     if (action)
     {
-        qDebug() << "open recent project:" << action->data().toString();
+        qkLog(Project) << "open recent project:" << action->data().toString();
         RecentProject recent;
         foreach(RecentProject rp, m_recentProjects) {
             if(rp.name.compare(action->data().toString()) == 0){
@@ -635,7 +883,7 @@ void QkIDE::slotOpenRecentProject()
 void QkIDE::slotOpenRecentProject(int i)
 {
     RecentProject recent = m_recentProjects.at(i);
-    qDebug() << "open recent" << recent.path + recent.name + ".qkpro";
+    qkLog(Project) << "open recent" << recent.path + recent.name + ".qkpro";
     openProject(recent.path + recent.name + ".qkpro");
 }
 
@@ -651,14 +899,16 @@ void QkIDE::slotCreateProject()
         if(saveProjectPath)
             m_projectDefaultLocation = path;
 
-        slotCloseProject();
-        qDebug() << "create project" << name << "under" << path;
+        if(!slotCloseProject())
+            return;
+        qkLog(Project) << "create project" << name << "under" << path;
         m_curProject = createProject(name);
         path = path.replace('\\', "/");
         path.append("/" + name + "/");
         m_curProject->setPath(path);
-        qDebug() << "new project path" << m_curProject->path();
+        qkLog(Project) << "new project path" << m_curProject->path();
         m_curProject->update();
+        m_journal->setFile(journalPath(m_curProject));
         slotSaveAllFiles();
         updateCurrentProject();
         updateInterface();
@@ -680,10 +930,10 @@ void QkIDE::slotOpenProject()
         openProject(path);
 }
 
-void QkIDE::slotCloseProject()
+bool QkIDE::slotCloseProject()
 {
     if(m_curProject == 0)
-        return;
+        return true;
 
     if(m_editor->hasModifiedPages()) {
         int r = QMessageBox::question(this, tr("Close"),
@@ -691,11 +941,21 @@ void QkIDE::slotCloseProject()
                                       QMessageBox::Save | QMessageBox::Discard, QMessageBox::Save);
         if(r == QMessageBox::Save) {
             slotSaveProject();
+            m_editor->waitForSaves();
+            // a failed write leaves its page modified, the journal must stay
+            if(m_editor->hasModifiedPages())
+            {
+                showErrorMessage(tr("Some files could not be saved.\n"
+                                    "The project was left open so your changes are not lost."));
+                return false;
+            }
         }
     }
 
+    m_journal->close();
     m_editor->closeAllPages();
     delete m_curProject;
+    return true;
 }
 
 void QkIDE::slotSaveProject()
@@ -712,10 +972,11 @@ void QkIDE::slotSaveAsProject()
     path.append("/");
     path.append(m_curProject->name() + "/");
     QDir().mkdir(path);
-    qDebug() << "save as new path" << path;
+    qkLog(Project) << "save as new path" << path;
     m_curProject->setPath(path);
     m_curProject->update();
     slotSaveAllFiles();
+    m_editor->waitForSaves();
     updateCurrentProject();
 
     QString curProjectPath = m_curProject->path();
@@ -738,8 +999,22 @@ void QkIDE::slotSaveAllFiles()
 
     for(int i=0; i < m_editor->countPages(); i++)
     {
-        QString filePath = m_curProject->path() + "/" + m_editor->page(i)->name();
-        m_editor->savePage(i,filePath);
+        if(!m_curProject->files().contains(m_editor->pageName(i)))
+            continue;
+        QString filePath = m_curProject->path() + "/" + m_editor->pageName(i);
+        if(m_editor->isPageLoaded(i))
+            m_editor->savePage(i,filePath);
+        else
+        {
+            // never opened, so it's unchanged: only copy it when saving elsewhere
+            QString sourcePath = m_editor->pageFilePath(i);
+            if(QFileInfo(sourcePath) != QFileInfo(filePath))
+            {
+                QFile::remove(filePath);
+                if(!QFile::copy(sourcePath, filePath))
+                    qDebug() << "can't copy" << sourcePath << "to" << filePath;
+            }
+        }
     }
 
     //m_curProject->save();
@@ -782,22 +1057,15 @@ void QkIDE::slotZoomOut()
 
 void QkIDE::slotClean()
 {
+    StallWatchdog::Phase phase("QkIDE::slotClean");
     //slotSaveProject();
     deleteMakefile(m_curProject);
     createMakefile(m_curProject);
 
-    QString makeCmd;
-#ifdef Q_OS_WIN
-    QString make = qApp->applicationDirPath() + GNUWIN_DIR + "/bin/make.exe";
-#else
-    QString make = "make";
-#endif
-
-    QStringList arguments;    
-    arguments << "clean";
-    arguments << "APP="+m_curProject->path();
+    QString make = makeProgram();
+    QStringList arguments = Builder::cleanArguments(m_curProject);
 
-    qDebug() << make << arguments;
+    qkLog(Build) << make << arguments;
 
     m_cleanProcess->setWorkingDirectory(m_curProject->path());
     m_cleanProcess->waitForFinished();
@@ -818,25 +1086,15 @@ void QkIDE::slotCleanProcessOutput()
 
 void QkIDE::slotVerify()
 {
+    StallWatchdog::Phase phase("QkIDE::slotVerify");
     //slotSaveProject();
     deleteMakefile(m_curProject);
     createMakefile(m_curProject);
 
-    qDebug() << "verify";
-
-    QString appDir = QApplication::applicationDirPath();
-    QString makeCmd;
-#ifdef Q_OS_WIN
-    makeCmd = appDir + GNUWIN_DIR + "/bin/make.exe";
-#else
-    makeCmd = "make";
-#endif
+    qkLog(Build) << "verify";
 
-    QString program = makeCmd;
-    QStringList arguments;
-    arguments << "app";
-    arguments << "APP=" + m_curProject->path();
-    arguments << "PROJECT_NAME=" + m_curProject->name();
+    QString program = makeProgram();
+    QStringList arguments = Builder::verifyArguments(m_curProject);
 
     m_verifyProcess->setWorkingDirectory(m_curProject->path());
     m_verifyProcess->waitForFinished();
@@ -867,36 +1125,143 @@ void QkIDE::slotVerifyProcessOutput()
 
 void QkIDE::slotUpload()
 {
+    StallWatchdog::Phase phase("QkIDE::slotUpload");
     createMakefile(m_curProject);
 
-    if(m_serialConn->isConnected())
+    if(m_serialConn != 0 && m_serialConn->isConnected())
         m_serialConn->close();
 
     m_uploadPortName = m_comboPort->currentText();
 
-    QString appDir = QApplication::applicationDirPath();
-    QString makeCmd;
-#ifdef Q_OS_WIN
-    makeCmd = appDir + GNUWIN_DIR + "/bin/make.exe";
-#else
-    makeCmd = "make";
-#endif
-
-    QString program = makeCmd;
-    QStringList arguments;
-    arguments << "upload";
-#ifdef Q_OS_WIN
-    arguments << "PORT=" + m_uploadPortName;
-#else
-    arguments << "PORT=/dev/" + m_uploadPortName;
-#endif
-    arguments << "FILE=" + m_curProject->path() + "bin/" + m_curProject->name() + ".bin";
+    QString program = makeProgram();
+    QStringList arguments = uploadArguments(m_uploadPortName);
 
     m_verifyProcess->setWorkingDirectory(m_curProject->path());
     m_verifyProcess->waitForFinished();
     m_verifyProcess->start(program, arguments);
 }
 
+void QkIDE::slotBatchUpload()
+{
+    m_batchUploadDialog->setPorts(serialPortNames());
+    m_batchUploadDialog->show();
+    m_batchUploadDialog->raise();
+}
+
+void QkIDE::slotStartBatchUpload(const QStringList &portNames)
+{
+    if(m_curProject == 0 || m_batchUploader->isRunning())
+        return;
+
+    createMakefile(m_curProject);
+
+    if(m_serialConn != 0 && m_serialConn->isConnected())
+        m_serialConn->close();
+
+    m_batchUploader->clear();
+    foreach(QString portName, portNames)
+    {
+        m_batchUploader->addJob(portName,
+                                makeProgram(),
+                                uploadArguments(portName),
+                                m_curProject->path());
+    }
+
+    m_outputWindow->clear();
+    m_outputWindow->show();
+    m_outputWindow->append(tr("Uploading to %1 boards...").arg(portNames.count()));
+    ui->statusBar->showMessage(tr("Uploading"));
+    updateInterface();
+
+    m_batchUploader->start();
+}
+
+void QkIDE::slotBatchUploadFinished()
+{
+    deleteMakefile(m_curProject);
+
+    foreach(QString portName, m_batchUploader->failedPorts())
+    {
+        m_outputWindow->append("[" + portName + "]", QColor("#FD8679"));
+        m_outputWindow->append(m_batchUploader->output(portName));
+    }
+
+    QString summary = m_batchUploader->summary();
+    if(m_batchUploader->failedPorts().isEmpty())
+        m_outputWindow->append(summary);
+    else
+        m_outputWindow->append(summary, QColor("#FD8679"));
+
+    ui->statusBar->showMessage(summary, 3000);
+    updateInterface();
+}
+
+void QkIDE::slotVerifyAllTargets()
+{
+    QStringList targets;
+    foreach(QString targetName, m_targets.keys())
+    {
+        foreach(Target::Board variant, m_targets.value(targetName).boards)
+            targets.append(targetName.toLower() + "." + variant.name.toLower());
+    }
+
+    m_buildMatrixDialog->setTargets(targets);
+    m_buildMatrixDialog->show();
+    m_buildMatrixDialog->raise();
+}
+
+void QkIDE::slotStartBuildMatrix(const QStringList &targets)
+{
+    if(m_curProject == 0 || m_buildMatrix->isRunning() || targets.isEmpty())
+        return;
+
+    QString matrixDir = QApplication::applicationDirPath() + TEMP_DIR +
+                        "/matrix/" + m_curProject->name();
+    QString makefilePath = matrixDir + "/Makefile";
+    QDir().mkpath(matrixDir);
+
+    QString first = targets.first();
+    if(!Builder::writeMakefile(makefilePath, m_curProject,
+                               first.section('.', 0, 0), first.section('.', 1)))
+        return;
+
+    m_buildMatrix->clear();
+    foreach(QString target, targets)
+    {
+        QString buildDir = matrixDir + "/" + target;
+        QDir().mkpath(buildDir);
+        m_buildMatrix->addJob(target,
+                              makeProgram(),
+                              Builder::matrixArguments(m_curProject, makefilePath, target, buildDir),
+                              buildDir,
+                              buildDir + "/bin/" + m_curProject->name() + ".bin");
+    }
+
+    ui->statusBar->showMessage(tr("Building %1 targets...").arg(targets.count()));
+    updateInterface();
+
+    m_buildMatrix->start();
+}
+
+void QkIDE::slotBuildMatrixFinished()
+{
+    QString summary = m_buildMatrix->summary();
+    if(!m_buildMatrix->failedTargets().isEmpty())
+    {
+        m_outputWindow->clear();
+        m_outputWindow->show();
+        foreach(QString target, m_buildMatrix->failedTargets())
+        {
+            m_outputWindow->append("[" + target + "]", QColor("#FD8679"));
+            m_outputWindow->append(m_buildMatrix->output(target));
+        }
+        m_outputWindow->append(summary, QColor("#FD8679"));
+    }
+
+    ui->statusBar->showMessage(summary, 3000);
+    updateInterface();
+}
+
 void QkIDE::slotUploadProcessStarted()
 {
     ui->statusBar->showMessage(tr("Uploading"));
@@ -925,16 +1290,178 @@ void QkIDE::slotProcessFinished()
 
 void QkIDE::slotShowReference()
 {
+    createReference();
     m_referenceWindow->show();
     m_referenceWindow->raise();
 }
 
 void QkIDE::slotShowExplorer()
 {
+    createExplorer();
+
+    // the docks join the window layout the first time they are asked for
+    foreach(QDockWidget *dock, m_explorerWidget->docks())
+    {
+        if(dockWidgetArea(dock) == Qt::NoDockWidgetArea)
+        {
+            dock->setParent(this);
+            addDockWidget(Qt::RightDockWidgetArea, dock);
+        }
+    }
     m_explorerWidget->show();
     m_explorerWidget->raise();
 }
 
+void QkIDE::slotShowDataLogger()
+{
+    m_dataLoggerWidget->setPorts(serialPortNames());
+    m_dataLoggerDock->show();
+    m_dataLoggerDock->raise();
+}
+
+void QkIDE::slotStalled(int duration, const QString &phases)
+{
+    ui->statusBar->showMessage(tr("UI stalled for %1 ms (%2)").arg(duration).arg(phases), 3000);
+}
+
+void QkIDE::slotShowStalls()
+{
+    QList<StallWatchdog::Stall> stalls = m_stallWatchdog->stalls();
+
+    m_outputWindow->clear();
+    m_outputWindow->show();
+    m_outputWindow->append(tr("%1 stalls above %2 ms")
+                           .arg(stalls.count())
+                           .arg(m_stallWatchdog->threshold()));
+    foreach(const StallWatchdog::Stall &stall, stalls)
+    {
+        m_outputWindow->append(stall.time.toString("hh:mm:ss.zzz") + "  " +
+                               QString::number(stall.duration).rightJustified(6) + " ms  " +
+                               stall.phases);
+    }
+}
+
+void QkIDE::slotReleaseSerialPort()
+{
+    if(m_serialConn != 0 && m_serialConn->isConnected())
+        m_serialConn->close();
+}
+
+void QkIDE::slotFindInProject()
+{
+    m_searchDock->show();
+    m_searchDock->raise();
+
+    Page *page = m_editor->currentPage();
+    if(page != 0 && page->textCursor().hasSelection())
+        m_searchWidget->setQuery(page->textCursor().selectedText());
+    else
+        m_searchWidget->setQuery(QString());
+}
+
+void QkIDE::slotSearchAboutToStart()
+{
+    QStringList paths;
+    QStringList texts;
+    foreach(Page *page, m_editor->pages())
+    {
+        if(page->document()->isModified() && m_curProject->files().contains(page->name()))
+        {
+            paths.append(QDir::cleanPath(m_curProject->path() + page->name()));
+            texts.append(page->text());
+        }
+    }
+    m_searchWidget->setOpenFiles(paths, texts);
+}
+
+void QkIDE::slotOpenLocation(const QString &filePath, int line, int column)
+{
+    if(m_curProject == 0)
+        return;
+
+    QString projectPath = QDir::cleanPath(m_curProject->path()) + "/";
+    QString pageName = filePath;
+    if(filePath.startsWith(projectPath))
+        pageName = filePath.mid(projectPath.size());
+
+    int index = m_editor->hasPage(pageName);
+    if(index == -1)
+    {
+        // files outside the project are opened read-only
+        m_editor->addLazyPage(filePath, filePath, QFileInfo(filePath).fileName());
+        index = m_editor->countPages() - 1;
+    }
+
+    m_editor->setCurrentPage(index);
+    Page *page = m_editor->loadPage(index);
+    if(page != 0)
+        page->goToLine(qMax(1, line), column);
+}
+
+void QkIDE::slotGoToDefinition(const QString &symbol)
+{
+    QList<SymbolIndex::Location> locations = m_symbolIndex.definitions(symbol);
+    if(locations.isEmpty())
+    {
+        ui->statusBar->showMessage(tr("No definition found for %1").arg(symbol), 2000);
+        return;
+    }
+
+    const SymbolIndex::Location &location = locations.first();
+    slotOpenLocation(location.filePath, location.line, 0);
+}
+
+void QkIDE::slotFindReferences(const QString &symbol)
+{
+    m_searchDock->show();
+    m_searchDock->raise();
+
+    // plain text search until the first index scan is done
+    if(m_occurrenceIndex->isReady())
+        showOccurrences(symbol, false);
+    else
+        m_searchWidget->findReferences(symbol);
+}
+
+void QkIDE::slotFindCallers(const QString &symbol)
+{
+    if(!m_occurrenceIndex->isReady())
+    {
+        ui->statusBar->showMessage(tr("Call sites are still being indexed"), 2000);
+        return;
+    }
+
+    m_searchDock->show();
+    m_searchDock->raise();
+    showOccurrences(symbol, true);
+}
+
+void QkIDE::showOccurrences(const QString &symbol, bool callsOnly)
+{
+    // the previews are read on the index thread and arrive a file at a time
+    m_occurrenceSymbol = symbol;
+    m_occurrenceCallsOnly = callsOnly;
+    int id = m_searchWidget->beginMatches(tr("Looking for %1...").arg(symbol));
+    m_occurrenceIndex->setCurrentPreview(id);
+    QMetaObject::invokeMethod(m_occurrenceIndex, "findPreviews", Qt::QueuedConnection,
+                              Q_ARG(int, id), Q_ARG(QString, symbol), Q_ARG(bool, callsOnly));
+}
+
+void QkIDE::slotOccurrencesFound(int id, const QList<SearchMatch> &matches)
+{
+    m_searchWidget->appendMatches(id, matches);
+}
+
+void QkIDE::slotOccurrencesFinished(int id, int matches)
+{
+    QString description;
+    if(m_occurrenceCallsOnly)
+        description = tr("%1 calls to %2").arg(matches).arg(m_occurrenceSymbol);
+    else
+        description = tr("%1 references to %2").arg(matches).arg(m_occurrenceSymbol);
+    m_searchWidget->finishMatches(id, description);
+}
+
 //void QkIDE::slotShowHideTarget()
 //{
 //    if(m_comboTargetName->isVisible())
@@ -1007,36 +1534,49 @@ Project* QkIDE::createProject(const QString &name)
 
 void QkIDE::openProject(const QString &path)
 {
-    Page *page;
-
-    slotCloseProject();
+    StallWatchdog::Phase phase("QkIDE::openProject");
+    if(!slotCloseProject())
+        return;
     m_curProject = new Project;
 
-    qDebug() << "load project from file" << path;
+    qkLog(Project) << "load project from file" << path;
 
     if(m_curProject->loadFromFile(path))
     {
-        qDebug() << "project path" << m_curProject->path();
+        qkLog(Project) << "project path" << m_curProject->path();
+
+        m_recoveredTexts.clear();
+        QHash<QString, QString> texts;
+        bool replaying = (m_eventRecorder != 0 && m_eventRecorder->isReplaying());
+        if(!replaying && EditJournal::recover(journalPath(m_curProject), m_curProject->path(), &texts))
+        {
+            QString msg = tr("\"%1\" has changes that were not saved in the last session.\n"
+                             "Do you want to recover them?").arg(m_curProject->name());
+            int r = QMessageBox::question(this, tr("Recover"), msg,
+                                          QMessageBox::Yes | QMessageBox::No,
+                                          QMessageBox::Yes);
+            if(r == QMessageBox::Yes)
+                m_recoveredTexts = texts;
+        }
+        m_journal->setFile(journalPath(m_curProject));
 
         foreach(QString fileName, m_curProject->files())
         {
-            QFile file(m_curProject->path() + fileName);
-            if(!file.open(QIODevice::ReadOnly))
+            QString filePath = m_curProject->path() + fileName;
+            if(!QFile::exists(filePath))
             {
                 qDebug() << "can't open file:" << fileName;
                 break;
             }
-            QTextStream in(&file);
-            QString text;
-            while (!in.atEnd())
-                text.append(in.readLine() + "\n");
 
-            page = m_editor->addPage(fileName);
-            page->setPlainText(text);
-            setupPage(page);
+            m_editor->addLazyPage(fileName, filePath);
         }
 
         m_editor->setCurrentPage(0);
+        m_editor->loadPage(0);
+
+        foreach(QString fileName, m_recoveredTexts.keys())
+            m_editor->loadPage(m_editor->hasPage(fileName));
 
         slotParse();
         updateCurrentProject();
@@ -1051,7 +1591,7 @@ void QkIDE::setTheme(const QString &name)
     QString path = qApp->applicationDirPath() + THEME_DIR +
                    "/" + name;
 
-    qDebug() << __FUNCTION__ << path;
+    qkLog(Editor) << __FUNCTION__ << path;
 
     Theme *theme = &m_globalTheme;
     if(Theme::generate(path, theme))
@@ -1073,6 +1613,10 @@ void QkIDE::setTheme(const QString &name)
             m_editor->setStyleSheet(editorStyleFile.readAll());
         else
             qDebug() << "failed to open style file:" << editorStyleFile.fileName();
+
+        if(!theme->syntax.isEmpty())
+            SyntaxDefinition::instance()->load(qApp->applicationDirPath() + THEME_DIR +
+                                               "/syntax/" + theme->syntax);
     }
 }
 
@@ -1084,6 +1628,13 @@ void QkIDE::setupPage(Page *page)
     completer->addElements(m_libElements, true);
     connect(page, SIGNAL(info(QString)), this, SLOT(showInfoMessage(QString)));
     connect(page, SIGNAL(keyPressed()), m_parserTimer, SLOT(start()));
+    connect(page, SIGNAL(edited(int,int,QString)), this, SLOT(slotPageEdited(int,int,QString)));
+    connect(page, SIGNAL(definitionRequested(QString)), this, SLOT(slotGoToDefinition(QString)));
+    connect(page, SIGNAL(referencesRequested(QString)), this, SLOT(slotFindReferences(QString)));
+    connect(page, SIGNAL(callersRequested(QString)), this, SLOT(slotFindCallers(QString)));
+    page->setOccurrenceIndex(m_occurrenceIndex);
+    page->setPreprocessor(m_preprocessor);
+    updateSemanticIndexer(page);
 
     Highlighter *highlighter = page->highlighter();
     highlighter->addElements(m_libElements, true);
@@ -1091,47 +1642,40 @@ void QkIDE::setupPage(Page *page)
 
 void QkIDE::createMakefile(Project *project)
 {
-    QFile makefileTemplateFile(":/templates/makefile_template");
-
-    if(!makefileTemplateFile.open(QIODevice::ReadOnly))
-    {
-        qDebug() << "unable to open makefile template";
-        return;
-    }
-
-    //QFile makefileFile(qApp->applicationDirPath() + TEMP_DIR + "/temp.mk");
-    QFile makefileFile(project->path() + "/Makefile");
-
-    if(!makefileFile.open(QIODevice::WriteOnly))
-    {
-        qDebug() << "unable to create makefile";
-        return;
-    }
-
-    QTextStream in(&makefileTemplateFile);
-    QTextStream out(&makefileFile);
-    QString makefileTemplate = in.readAll();
-
-    QString appDir = qApp->applicationDirPath();
+    Builder::createMakefile(project,
+                            m_comboTargetName->currentText(),
+                            m_comboTargetVariant->currentText());
+}
 
-    QString targetName = m_comboTargetName->currentText().toLower();
-    QString targetVariant = m_comboTargetVariant->currentText().toLower();
-    QString target = targetName + "." + targetVariant;
+void QkIDE::deleteMakefile(Project *project)
+{
+    Builder::deleteMakefile(project);
+}
 
-    makefileTemplate.replace("{{embDir}}", appDir + EMB_DIR);
-    makefileTemplate.replace("{{toolchainDir}}", appDir + TOOLCHAIN_DIR);
-    makefileTemplate.replace("{{appDir}}", project->path());
-    makefileTemplate.replace("{{target}}", target);
+QString QkIDE::makeProgram()
+{
+    return Builder::makeProgram();
+}
 
-    out << makefileTemplate;
+QStringList QkIDE::uploadArguments(const QString &portName)
+{
+    return Builder::uploadArguments(m_curProject, portName);
+}
 
-    makefileTemplateFile.close();
-    makefileFile.close();
+QString QkIDE::journalPath(Project *project)
+{
+    // a replay must not truncate or remove a journal waiting for recovery
+    if(m_eventRecorder != 0 && m_eventRecorder->isReplaying())
+        return QApplication::applicationDirPath() + TEMP_DIR + "/replay.qkjournal";
+    return project->path() + "." + project->name() + ".qkjournal";
 }
 
-void QkIDE::deleteMakefile(Project *project)
+QStringList QkIDE::serialPortNames()
 {
-    QFile::remove(project->path() + "/Makefile");
+    QStringList list;
+    for(int i = 0; i < m_comboPort->count(); i++)
+        list.append(m_comboPort->itemText(i));
+    return list;
 }
 
 void QkIDE::slotSplitHorizontal()
@@ -1170,7 +1714,7 @@ void QkIDE::updateCurrentProject()
 {
     updateWindowTitle();
 
-    qDebug() << "current project:" << m_curProject->name() << m_curProject->path();
+    qkLog(Project) << "current project:" << m_curProject->name() << m_curProject->path();
 
     if(!m_curProject->readOnly())
     {
@@ -1210,6 +1754,7 @@ void QkIDE::updateRecentProjects()
     for (int j = numRecentProjects; j < MaxRecentProjects; ++j)
         m_recentProjectsActs[j]->setVisible(false);
 
+    StartupProfiler::Scope scope("home page");
     QString htmlText;
     QString str = "<li id=\"recent\"><a href=\"prj:recent:%1\"><b>%2</b></a><br>%3</li>\n";
 
@@ -1226,7 +1771,7 @@ void QkIDE::updateRecentProjects()
                            " <a href=\"prj:create\">creating a new one</a>"
                            " or by checking some examples under <i>File>Examples</i>."));
 
-    qDebug() << "create html";
+    qkLog(Project) << "create html";
 
     QFile homeTemplateFile(":/html/home.html");
     QFile homeFile(QApplication::applicationDirPath() + "/resources/html/home.html");
@@ -1255,7 +1800,7 @@ void QkIDE::updateRecentProjects()
 
     m_browser->load(QUrl::fromLocalFile(QApplication::applicationDirPath() + "/resources/html/home.html"));
 
-    qDebug() << "recentProjects updated";
+    qkLog(Project) << "recentProjects updated";
 }
 
 void QkIDE::updateInterface()
@@ -1266,6 +1811,7 @@ void QkIDE::updateInterface()
     m_redoAct->setEnabled(projectActEnabled);
     m_undoAct->setEnabled(projectActEnabled);
     m_searchAct->setEnabled(projectActEnabled);
+    m_findInProjectAct->setEnabled(projectActEnabled);
 
     m_saveProjectAct->setEnabled(buildActEnabled);;
     m_saveAsProjectAct->setEnabled(projectActEnabled);;
@@ -1274,6 +1820,9 @@ void QkIDE::updateInterface()
     m_cleanAct->setEnabled(buildActEnabled);
     m_verifyAct->setEnabled(buildActEnabled);
     m_uploadAct->setEnabled(buildActEnabled && m_comboPort->count() > 0);
+    m_batchUploadAct->setEnabled(buildActEnabled && m_comboPort->count() > 0 &&
+                                 !m_batchUploader->isRunning());
+    m_verifyAllAct->setEnabled(buildActEnabled && !m_buildMatrix->isRunning());
 
     QString targetName = m_comboTargetName->currentText();
     Target target = m_targets.value(targetName);
@@ -1309,6 +1858,18 @@ bool QkIDE::doYouReallyWantToQuit()
         {
         case QMessageBox::Save:
             slotSaveAllFiles();
+            m_editor->waitForSaves();
+            // a failed write leaves its page modified, the journal must stay
+            if(m_editor->hasModifiedPages())
+            {
+                showErrorMessage(tr("Some files could not be saved.\n"
+                                    "Your changes were kept, save them again "
+                                    "or discard them before quitting."));
+                quit = false;
+                break;
+            }
+            quit = true;
+            break;
         case QMessageBox::Discard:
             quit = true;
             break;
@@ -1328,6 +1889,9 @@ void QkIDE::closeEvent(QCloseEvent *e)
     {
         m_verifyProcess->kill();
         m_uploadProcess->kill();
+        m_batchUploader->abort();
+        m_buildMatrix->abort();
+        m_journal->close();
     }
     QMainWindow::closeEvent(e);
 }
@@ -1337,9 +1901,70 @@ void QkIDE::slotCurrentProjectChanged()
     if(m_curProject != 0)
     {
         //m_codeParserThread->setParserPath(m_curProject->path());
+        m_searchWidget->setProjectPath(m_curProject->path());
+
+        QStringList roots;
+        roots << m_curProject->path()
+              << QApplication::applicationDirPath() + QKPROGRAM_DIR
+              << QApplication::applicationDirPath() + QKPERIPHERAL_DIR;
+        QMetaObject::invokeMethod(m_occurrenceIndex, "setRoots", Qt::QueuedConnection,
+                                  Q_ARG(QStringList, roots));
+
+        if(m_eventRecorder != 0)
+            m_eventRecorder->setProject(m_curProject->path() + m_curProject->name() + ".qkpro");
     }
 }
 
+void QkIDE::createEventRecorder()
+{
+    if(m_eventRecorder != 0)
+        return;
+
+    m_eventRecorder = new EventRecorder(m_editor, this);
+    connect(m_eventRecorder, SIGNAL(projectRequested(QString)),
+            this, SLOT(slotReplayProject(QString)));
+    connect(m_eventRecorder, SIGNAL(replayFinished()), this, SLOT(slotReplayFinished()));
+
+    if(m_curProject != 0)
+        m_eventRecorder->setProject(m_curProject->path() + m_curProject->name() + ".qkpro");
+}
+
+bool QkIDE::recordEvents(const QString &filePath)
+{
+    createEventRecorder();
+    return m_eventRecorder->startRecording(filePath);
+}
+
+bool QkIDE::replayEvents(const QString &filePath)
+{
+    createEventRecorder();
+    return m_eventRecorder->startReplay(filePath);
+}
+
+void QkIDE::slotReplayProject(const QString &filePath)
+{
+    // replayed edits are thrown away, never saved or recovered
+    foreach(Page *page, m_editor->pages())
+        page->document()->setModified(false);
+    openProject(filePath);
+}
+
+void QkIDE::slotReplayFinished()
+{
+    foreach(Page *page, m_editor->pages())
+        page->document()->setModified(false);
+    m_journal->close();
+    m_journal->waitForIdle();
+
+    QString report = m_eventRecorder->report();
+    QFile reportFile(QApplication::applicationDirPath() + TEMP_DIR + "/replay_report.txt");
+    if(reportFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        reportFile.write(report.toUtf8());
+
+    QTextStream(stdout) << report;
+    qApp->exit(0);
+}
+
 void QkIDE::slotConnect()
 {
 //    qDebug() << "slotConnect()";
@@ -1365,7 +1990,8 @@ void QkIDE::slotConnect()
 
 void QkIDE::slotParse()
 {
-    qDebug() << __FUNCTION__;
+    StallWatchdog::Phase phase("QkIDE::slotParse");
+    qkLog(Parser) << __FUNCTION__;
 
     QString tagsPath = QApplication::applicationDirPath() + TAGS_DIR;
 
@@ -1373,9 +1999,18 @@ void QkIDE::slotParse()
     QDir().mkdir(tagsPath);
 
     QFile file;
-    foreach(Page *page, m_editor->pages())
+    for(int i = 0; i < m_editor->countPages(); i++)
     {
-        QString destPath = tagsPath + "/" + page->name();
+        if(!m_curProject->files().contains(m_editor->pageName(i)))
+            continue;
+        QString destPath = tagsPath + "/" + m_editor->pageName(i);
+        Page *page = m_editor->page(i);
+        if(page == 0)
+        {
+            if(!QFile::copy(m_editor->pageFilePath(i), destPath))
+                qDebug() << "cant create file" << destPath;
+            continue;
+        }
         file.setFileName(destPath);
         if(file.open(QIODevice::WriteOnly))
         {
@@ -1398,7 +2033,13 @@ void QkIDE::slotParse()
 
 void QkIDE::slotParsed()
 {
-    qDebug() << __FUNCTION__;
+    StallWatchdog::Phase phase("QkIDE::slotParsed");
+    qkLog(Parser) << __FUNCTION__;
+
+    if(m_curProject != 0)
+        m_symbolIndex.setProject(m_codeParser->tags(),
+                                 QApplication::applicationDirPath() + TAGS_DIR,
+                                 m_curProject->path());
 
     foreach(Page *page, m_editor->pages())
     {
@@ -1413,6 +2054,154 @@ void QkIDE::slotParsed()
         highlighter->addElements(m_codeParser->allElements());
         page->highlighter()->rehighlight();
     }
+
+    updatePreprocessor();
+}
+
+void QkIDE::slotTargetChanged()
+{
+    // the variant list is refilled on every interface update
+    QString targetVariant = m_comboTargetVariant->currentText();
+    if(targetVariant.isEmpty())
+        return;
+
+    QString target = m_comboTargetName->currentText().toLower() + "." + targetVariant.toLower();
+    if(target == m_preprocessorTarget)
+        return;
+    m_preprocessorTarget = target;
+
+    Preprocessor::Defines defines =
+            Preprocessor::targetDefines(QApplication::applicationDirPath() + EMB_DIR,
+                                        m_comboTargetName->currentText(), targetVariant);
+
+    if(!m_targetLibElements.contains(target))
+    {
+        QSet<QString> macros;
+        QSet<QString> headers;
+        addExternalMacros(m_libTags, &macros, &headers);
+        addExternalMacros(m_peripheralTags, &macros, &headers);
+        Preprocessor preprocessor(defines, macros, headers);
+        m_targetLibElements.insert(target, preprocessor.activeElements(m_libTags));
+    }
+    m_libElements = m_targetLibElements.value(target);
+
+    foreach(Page *page, m_editor->pages())
+    {
+        Completer *completer = page->completer();
+        completer->clearElements(true);
+        completer->addElements(m_libElements, true);
+        completer->addElements(m_codeParser->allElements());
+        updateSemanticIndexer(page);
+    }
+
+    updatePreprocessor();
+}
+
+void QkIDE::updateSemanticIndexer(Page *page)
+{
+    if(m_semanticIndexer == 0 || m_curProject == 0)
+        return;
+
+    QString appDir = QApplication::applicationDirPath();
+    QString targetName = m_comboTargetName->currentText().toLower();
+    QString targetVariant = m_comboTargetVariant->currentText().toLower();
+
+    // the same flags the makefile passes to the compiler
+    QStringList arguments;
+    arguments << "-xc" << "-std=gnu99"
+              << "-I" + m_curProject->path()
+              << "-I" + appDir + QKPROGRAM_INC_DIR
+              << "-I" + appDir + QKPERIPHERAL_DIR + "/include"
+              << "-I" + appDir + QKPERIPHERAL_DIR + "/include/board/" + targetName + "/" + targetVariant;
+
+    Preprocessor::Defines defines = Preprocessor::targetDefines(appDir + EMB_DIR, targetName, targetVariant);
+    foreach(QString name, defines.keys())
+    {
+        if(defines.value(name).isEmpty())
+            arguments << "-D" + name;
+        else
+            arguments << "-D" + name + "=" + defines.value(name);
+    }
+
+    QString filePath = page->name();
+    if(!QFileInfo(filePath).isAbsolute())
+        filePath = QDir::cleanPath(m_curProject->path() + page->name());
+
+    page->setSemanticIndexer(m_semanticIndexer, filePath, arguments);
+}
+
+void QkIDE::updatePreprocessor()
+{
+    if(m_preprocessorTarget.isEmpty())
+        return;
+
+    // macros any header might define are left undecided
+    QSet<QString> macros;
+    QSet<QString> headers;
+    addExternalMacros(m_libTags, &macros, &headers);
+    addExternalMacros(m_peripheralTags, &macros, &headers);
+    addExternalMacros(m_codeParser->tags(), &macros, &headers);
+
+    m_preprocessor = Preprocessor(Preprocessor::targetDefines(QApplication::applicationDirPath() + EMB_DIR,
+                                                              m_comboTargetName->currentText(),
+                                                              m_comboTargetVariant->currentText()),
+                                  macros, headers);
+    foreach(Page *page, m_editor->pages())
+        page->setPreprocessor(m_preprocessor);
+}
+
+void QkIDE::addExternalMacros(const QList<CodeParser::Element> &tags,
+                              QSet<QString> *macros, QSet<QString> *headers)
+{
+    foreach(const CodeParser::Element &tag, tags)
+    {
+        if(tag.type == CodeParser::Element::Define)
+            macros->insert(tag.text);
+        headers->insert(QFileInfo(tag.fileName).fileName());
+    }
+}
+
+void QkIDE::slotPageCreated(Page *page)
+{
+    setupPage(page);
+    if(!m_curProject->files().contains(page->name()))
+        page->setReadOnly(true);
+    connect(page, SIGNAL(loaded()), this, SLOT(slotPageLoaded()));
+
+    page->completer()->addElements(m_codeParser->allElements());
+    page->highlighter()->addElements(m_codeParser->allElements());
+    page->highlighter()->rehighlight();
+}
+
+void QkIDE::slotPageLoaded()
+{
+    Page *page = qobject_cast<Page *>(sender());
+    if(page == 0)
+        return;
+
+    m_journal->open(page->name(), page->text());
+
+    if(m_recoveredTexts.contains(page->name()))
+    {
+        // a single edit, so the recovered changes can be undone
+        QTextCursor tc(page->document());
+        tc.select(QTextCursor::Document);
+        tc.insertText(m_recoveredTexts.take(page->name()));
+    }
+}
+
+void QkIDE::slotPageEdited(int position, int charsRemoved, const QString &text)
+{
+    Page *page = qobject_cast<Page *>(sender());
+    if(page != 0)
+        m_journal->edit(page->name(), position, charsRemoved, text);
+}
+
+void QkIDE::slotPageWritten(Page *page)
+{
+    m_journal->saved(page->name(), page->text());
+    QMetaObject::invokeMethod(m_occurrenceIndex, "updateFile", Qt::QueuedConnection,
+                              Q_ARG(QString, QDir::cleanPath(m_curProject->path() + page->name())));
 }
 
 void QkIDE::slotError(const QString &message)
@@ -1423,15 +2212,34 @@ void QkIDE::slotError(const QString &message)
 
 void QkIDE::slotReloadSerialPorts()
 {
-    QStringList list;
-    foreach(QSerialPortInfo info, QSerialPortInfo::availablePorts())
-    {
-        QString portName = info.portName();
-        if(portName.contains("ACM") || portName.contains("USB"))
-            list.append(portName);
-    }
-    m_comboPort->clear();
-    m_comboPort->addItems(list);
+    QMetaObject::invokeMethod(m_portMonitor, "refresh", Qt::QueuedConnection);
+}
+
+void QkIDE::slotSerialPortAdded(const QString &portName)
+{
+    if(m_comboPort->findText(portName) != -1)
+        return;
+
+    int i = 0;
+    while(i < m_comboPort->count() && m_comboPort->itemText(i) < portName)
+        i++;
+    m_comboPort->insertItem(i, portName);
+    if(!m_dataLoggerWidget->isCapturing())
+        m_dataLoggerWidget->setPorts(serialPortNames());
+    ui->statusBar->showMessage(tr("Serial port %1 connected").arg(portName), 2000);
+    updateInterface();
+}
+
+void QkIDE::slotSerialPortRemoved(const QString &portName)
+{
+    int i = m_comboPort->findText(portName);
+    if(i == -1)
+        return;
+
+    m_comboPort->removeItem(i);
+    if(!m_dataLoggerWidget->isCapturing())
+        m_dataLoggerWidget->setPorts(serialPortNames());
+    ui->statusBar->showMessage(tr("Serial port %1 disconnected").arg(portName), 2000);
     updateInterface();
 }
 
@@ -21,8 +21,12 @@
 #define QKIDE_H
 
 #include <QMainWindow>
+#include <QHash>
 #include "qkide_global.h"
 #include "editor/codeparser.h"
+#include "editor/symbolindex.h"
+#include "editor/preprocessor.h"
+#include "searchindex.h"
 #include "qkutils.h"
 #include "theme.h"
 
@@ -44,6 +48,20 @@ class HomeHeader;
 class QkReferenceWidget;
 class QkExplorerWidget;
 class QkConnSerial;
+class BatchUploader;
+class SerialPortMonitor;
+class EditJournal;
+class OccurrenceIndex;
+class SemanticIndexer;
+class DataLoggerWidget;
+class SearchWidget;
+class PerfHudWidget;
+class LogViewerWidget;
+class BatchUploadDialog;
+class BuildMatrix;
+class BuildMatrixDialog;
+class EventRecorder;
+class StallWatchdog;
 class CodeParser;
 class CodeParserThread;
 class QComboBox;
@@ -64,14 +82,20 @@ public:
     explicit QkIDE(QWidget *parent = 0);
     ~QkIDE();
 
+    bool recordEvents(const QString &filePath);
+    bool replayEvents(const QString &filePath);
+
 public slots:
     void showInfoMessage(const QString &msg);
     void showErrorMessage(const QString &msg);
 
 protected:
     void closeEvent(QCloseEvent *e);
+    bool eventFilter(QObject *obj, QEvent *e);
 
 private slots:
+    void slotReplayProject(const QString &filePath);
+    void slotReplayFinished();
     void slotCleanProcessStarted();
     void slotCleanProcessOutput();
     void slotVerifyProcessStarted();
@@ -87,7 +111,7 @@ private slots:
     void slotOpenRecentProject(int i);
     void slotCreateProject();
     void slotOpenProject();
-    void slotCloseProject();
+    bool slotCloseProject();
     void slotSaveProject();
     void slotSaveAsProject();
     void slotSaveAllFiles();
@@ -101,10 +125,29 @@ private slots:
     void slotClean();
     void slotVerify();
     void slotUpload();
+    void slotBatchUpload();
+    void slotStartBatchUpload(const QStringList &portNames);
+    void slotBatchUploadFinished();
+    void slotVerifyAllTargets();
+    void slotStartBuildMatrix(const QStringList &targets);
+    void slotBuildMatrixFinished();
     void slotConnect();
 
     void slotShowReference();
     void slotShowExplorer();
+    void slotWarmUp();
+    void slotShowDataLogger();
+    void slotStalled(int duration, const QString &phases);
+    void slotShowStalls();
+    void slotReleaseSerialPort();
+    void slotFindInProject();
+    void slotSearchAboutToStart();
+    void slotOpenLocation(const QString &filePath, int line, int column);
+    void slotGoToDefinition(const QString &symbol);
+    void slotFindReferences(const QString &symbol);
+    void slotFindCallers(const QString &symbol);
+    void slotOccurrencesFound(int id, const QList<SearchMatch> &matches);
+    void slotOccurrencesFinished(int id, int matches);
 
     void slotToggleFold();
     void slotFullScreen(bool on);
@@ -114,10 +157,17 @@ private slots:
     void slotCurrentProjectChanged();
     void slotParse();
     void slotParsed();
+    void slotTargetChanged();
+    void slotPageCreated(Page *page);
+    void slotPageLoaded();
+    void slotPageEdited(int position, int charsRemoved, const QString &text);
+    void slotPageWritten(Page *page);
     bool doYouReallyWantToQuit();
     void updateInterface();
     void slotError(const QString &message);
     void slotReloadSerialPorts();
+    void slotSerialPortAdded(const QString &portName);
+    void slotSerialPortRemoved(const QString &portName);
     void slotTest();
 
 signals:
@@ -129,6 +179,8 @@ private:
     void createToolbars();
     void createExamples();
     void createReference();
+    void createExplorer();
+    void createEventRecorder();
     void setupLayout();
     void readSettings();
     void writeSettings();
@@ -136,15 +188,26 @@ private:
     void openProject(const QString &path);
     void createMakefile(Project *project);
     void deleteMakefile(Project *project);
+    QString makeProgram();
+    QStringList uploadArguments(const QString &portName);
+    QStringList serialPortNames();
+    QString journalPath(Project *project);
     void updateWindowTitle();
     void updateCurrentProject();
     void updateRecentProjects();
 
     void setTheme(const QString &name);
     void setupPage(Page *page);
+    void showOccurrences(const QString &symbol, bool callsOnly);
+    void updatePreprocessor();
+    void addExternalMacros(const QList<CodeParser::Element> &tags,
+                           QSet<QString> *macros, QSet<QString> *headers);
+    void updateSemanticIndexer(Page *page);
 
     enum Constants {
-        MaxRecentProjects = 6
+        MaxRecentProjects = 6,
+        WarmUpDelay = 5000,
+        DefaultStallThreshold = 200
     };
 
     class RecentProject {
@@ -171,6 +234,12 @@ private:
     QTimer *m_parserTimer;
 
     QList<CodeParser::Element> m_libElements;
+    QList<CodeParser::Element> m_libTags;
+    QList<CodeParser::Element> m_peripheralTags;
+    QHash<QString, QList<CodeParser::Element> > m_targetLibElements;
+    QString m_preprocessorTarget;
+    Preprocessor m_preprocessor;
+    SymbolIndex m_symbolIndex;
 
     QMap<QString, QkUtils::Target> m_targets;
 
@@ -181,6 +250,7 @@ private:
     QAction *m_ProjectPreferencesAct;
 
     QAction *m_searchAct;
+    QAction *m_findInProjectAct;
 
     QAction *m_homeAct;
 
@@ -197,9 +267,12 @@ private:
     QAction *m_cleanAct;
     QAction *m_verifyAct;
     QAction *m_uploadAct;
+    QAction *m_batchUploadAct;
+    QAction *m_verifyAllAct;
 
     QAction *m_referenceAct;
     QAction *m_explorerAct;
+    QAction *m_dataLoggerAct;
 //    QAction *m_connectAct;
 //    QAction *m_targetAct;
     QAction *m_testAct;
@@ -211,6 +284,7 @@ private:
     QAction *m_splitHorizontalAct;
     QAction *m_splitVerticalAct;
     QAction *m_removeSplitAct;
+    QAction *m_showStallsAct;
 
     QAction *m_optionsAct;
 
@@ -245,11 +319,36 @@ private:
     QProcess *m_verifyProcess;
     QProcess *m_uploadProcess;
 
+    BatchUploader *m_batchUploader;
+    BatchUploadDialog *m_batchUploadDialog;
+    BuildMatrix *m_buildMatrix;
+    BuildMatrixDialog *m_buildMatrixDialog;
+
     QString m_uploadPortName;
     QString m_projectDefaultLocation;
 
     QkConnSerial *m_serialConn;
 
+    SerialPortMonitor *m_portMonitor;
+    QThread *m_portMonitorThread;
+
+    EditJournal *m_journal;
+    QThread *m_journalThread;
+    QHash<QString, QString> m_recoveredTexts;
+
+    OccurrenceIndex *m_occurrenceIndex;
+    QThread *m_occurrenceThread;
+    QString m_occurrenceSymbol;
+    bool m_occurrenceCallsOnly;
+
+    SemanticIndexer *m_semanticIndexer;
+    QThread *m_semanticThread;
+
+    EventRecorder *m_eventRecorder;
+
+    StallWatchdog *m_stallWatchdog;
+    int m_stallThreshold;
+
     QAction *m_buttonRefreshPorts;
     QComboBox *m_comboPort;
     QComboBox *m_comboBaud;
@@ -262,9 +361,23 @@ private:
     QkExplorerWidget *m_explorerWidget;
     QDockWidget *m_explorerDock;
 
+    DataLoggerWidget *m_dataLoggerWidget;
+    QDockWidget *m_dataLoggerDock;
+
+    SearchWidget *m_searchWidget;
+    QDockWidget *m_searchDock;
+
+    PerfHudWidget *m_perfHudWidget;
+    QDockWidget *m_perfDock;
+
+    LogViewerWidget *m_logViewerWidget;
+    QDockWidget *m_logDock;
+
     QMainWindow *m_explorerWindow;
     QMainWindow *m_referenceWindow;
 
+    QTimer *m_warmUpTimer;
+
 };
 
 #endif // QKIDE_H
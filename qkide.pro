@@ -34,6 +34,12 @@ INCLUDEPATH += ../qkwidget
 QMAKE_LIBDIR += /home/$$(USER)/qkthings_local/build/qt/qkwidget/release
 LIBS += -L/home/$$(USER)/qkthings_local/build/qt/qkwidget/release -lqkwidget
 
+# semantic highlighting, enabled with: qmake CONFIG+=libclang
+libclang {
+    DEFINES += QKIDE_LIBCLANG
+    LIBS += -lclang
+}
+
 SOURCES += main.cpp\
         qkide.cpp \
     gui/editor/editor.cpp \
@@ -55,7 +61,36 @@ SOURCES += main.cpp\
     gui/editor/codetip.cpp \
     core/theme.cpp \
     core/project.cpp \
-    gui/widgets/qkreferencewidget.cpp
+    gui/widgets/qkreferencewidget.cpp \
+    core/batchuploader.cpp \
+    core/batchuploaddialog.cpp \
+    core/serialportmonitor.cpp \
+    core/binarylog.cpp \
+    core/serialcapture.cpp \
+    gui/widgets/pplotwidget.cpp \
+    gui/widgets/dataloggerwidget.cpp \
+    core/textfile.cpp \
+    core/filesaver.cpp \
+    core/editjournal.cpp \
+    core/searchindex.cpp \
+    core/projectsearch.cpp \
+    gui/widgets/searchwidget.cpp \
+    gui/editor/matchcounter.cpp \
+    gui/editor/symbolindex.cpp \
+    core/occurrenceindex.cpp \
+    gui/editor/preprocessor.cpp \
+    gui/editor/semanticindexer.cpp \
+    core/startupprofiler.cpp \
+    gui/editor/syntaxdefinition.cpp \
+    core/builder.cpp \
+    core/buildmatrix.cpp \
+    core/buildmatrixdialog.cpp \
+    core/eventrecorder.cpp \
+    core/perfcounters.cpp \
+    gui/widgets/perfhudwidget.cpp \
+    core/stallwatchdog.cpp \
+    core/applog.cpp \
+    gui/widgets/logviewerwidget.cpp
 
 HEADERS  += qkide.h \
     qkide_global.h \
@@ -78,7 +113,37 @@ HEADERS  += qkide.h \
     gui/editor/codetip.h \
     core/theme.h \
     core/project.h \
-    gui/widgets/qkreferencewidget.h
+    gui/widgets/qkreferencewidget.h \
+    core/batchuploader.h \
+    core/batchuploaddialog.h \
+    core/serialportmonitor.h \
+    core/ringbuffer.h \
+    core/binarylog.h \
+    core/serialcapture.h \
+    gui/widgets/pplotwidget.h \
+    gui/widgets/dataloggerwidget.h \
+    core/textfile.h \
+    core/filesaver.h \
+    core/editjournal.h \
+    core/searchindex.h \
+    core/projectsearch.h \
+    gui/widgets/searchwidget.h \
+    gui/editor/matchcounter.h \
+    gui/editor/symbolindex.h \
+    core/occurrenceindex.h \
+    gui/editor/preprocessor.h \
+    gui/editor/semanticindexer.h \
+    core/startupprofiler.h \
+    gui/editor/syntaxdefinition.h \
+    core/builder.h \
+    core/buildmatrix.h \
+    core/buildmatrixdialog.h \
+    core/eventrecorder.h \
+    core/perfcounters.h \
+    gui/widgets/perfhudwidget.h \
+    core/stallwatchdog.h \
+    core/applog.h \
+    gui/widgets/logviewerwidget.h
 
 FORMS    += qkide.ui \
     gui/editor/findreplacedialog.ui \